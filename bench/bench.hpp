@@ -0,0 +1,96 @@
+#ifndef ELF_BENCH_H
+#define ELF_BENCH_H
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include <new>
+
+/* Tiny, header-only timing harness for the microbenchmarks. */
+namespace elf_bench
+{
+	/* Allocations so far; only counted in benchmarks that define `ELF_BENCH_COUNT_ALLOCATIONS`
+	 * before including this (the counting `operator new` can only be in one file).
+	 * */
+	inline uint64_t allocation_count = 0;
+
+	struct Measurement
+	{
+		uint64_t	iterations;
+		double		ns_per_op;
+		double		allocations_per_op;
+	};
+
+	/* Keep the compiler from optimizing away a result that is never used. */
+	template<typename T>
+	inline void do_not_optimize(T const &value)
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	/* Run `operation` `iterations` times (after a short warm up) and return the average ns/op. */
+	template<typename F>
+	double ns_per_op(F &&operation, uint64_t iterations)
+	{
+		for(uint64_t i = 0; i < iterations / 10 + 1; i++)
+			operation();
+
+		auto start = std::chrono::steady_clock::now();
+		for(uint64_t i = 0; i < iterations; i++)
+			operation();
+		auto end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+	}
+
+	/* Like `ns_per_op`, but picks the amount of iterations itself (enough to run for about
+	 * `seconds`) and counts the allocations made while measuring.
+	 * */
+	template<typename F>
+	struct Measurement measure(F &&operation, double seconds = 0.2)
+	{
+		uint64_t iterations = 1;
+
+		/* Double up until a run is long enough to scale from. */
+		while(true)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for(uint64_t i = 0; i < iterations; i++)
+				operation();
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if(elapsed >= seconds / 10)
+			{
+				iterations = iterations * (seconds / elapsed) + 1;
+				break;
+			}
+			iterations *= 2;
+		}
+
+		uint64_t allocations = allocation_count;
+		double ns = ns_per_op(operation, iterations);
+
+		/* The warm up `ns_per_op` does is counted too. */
+		uint64_t counted_iterations = iterations + iterations / 10 + 1;
+		return { iterations, ns, (double) (allocation_count - allocations) / counted_iterations };
+	}
+}
+
+#ifdef ELF_BENCH_COUNT_ALLOCATIONS
+void *operator new(size_t size)
+{
+	elf_bench::allocation_count++;
+
+	if(void *memory = malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete[](void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+void operator delete[](void *memory, size_t) noexcept { free(memory); }
+#endif
+
+#endif
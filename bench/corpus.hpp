@@ -0,0 +1,265 @@
+#ifndef ELF_BENCH_CORPUS_H
+#define ELF_BENCH_CORPUS_H
+#include <elf_header.hpp>
+#include <elf_notes.hpp>
+#include <vector>
+using namespace elf_header;
+using namespace elf_notes;
+
+/* Synthetic ELF binary files for the benchmarks, built in memory from a profile and a seed.
+ * The same profile and seed always give the same bytes, so a corpus can be thrown away and
+ * made again without the numbers moving.
+ *
+ * Every image is a well-formed executable: the header, `segment_amnt` program headers (a
+ * `PT_LOAD` over the whole file and a `PT_NOTE`, then `PT_NULL` filler), a build ID note,
+ * `payload_size` bytes of `.text`, a `.symtab` of `symbol_amnt` functions with its `.strtab`,
+ * `.shstrtab`, empty filler sections up to `section_amnt`, and the section header table last.
+ * Counts too large for the header use extended numbering (in section header 0).
+ * */
+namespace elf_bench
+{
+	struct CorpusProfile
+	{
+		const char	*name;
+		uint8_t		elf_class;			/* `ELF_CLASS_32`/`ELF_CLASS_64` */
+		uint8_t		elf_data;			/* `ELF_DATA_LITTLE`/`ELF_DATA_BIG` */
+		uint32_t	segment_amnt;		/* at least 2 */
+		uint32_t	section_amnt;		/* at least 6 */
+		uint32_t	symbol_amnt;		/* at least 1 (the null symbol) */
+		uint64_t	payload_size;
+		uint32_t	copies;				/* files of this profile in a corpus */
+	};
+
+	/* What `make_corpus` writes; the first letters of a name say which group it is in. */
+	static const struct CorpusProfile corpus_profiles[] = {
+		{ "small-32-le",		ELF_CLASS_32, ELF_DATA_LITTLE,	8,		16,		64,		0x1000,		256 },
+		{ "small-32-be",		ELF_CLASS_32, ELF_DATA_BIG,		8,		16,		64,		0x1000,		256 },
+		{ "small-64-le",		ELF_CLASS_64, ELF_DATA_LITTLE,	8,		16,		64,		0x1000,		256 },
+		{ "small-64-be",		ELF_CLASS_64, ELF_DATA_BIG,		8,		16,		64,		0x1000,		256 },
+		{ "large-32-le",		ELF_CLASS_32, ELF_DATA_LITTLE,	16,		64,		20000,	0x200000,	4 },
+		{ "large-32-be",		ELF_CLASS_32, ELF_DATA_BIG,		16,		64,		20000,	0x200000,	4 },
+		{ "large-64-le",		ELF_CLASS_64, ELF_DATA_LITTLE,	16,		64,		20000,	0x200000,	4 },
+		{ "large-64-be",		ELF_CLASS_64, ELF_DATA_BIG,		16,		64,		20000,	0x200000,	4 },
+		{ "extreme-phnum-64-le",	ELF_CLASS_64, ELF_DATA_LITTLE,	70000,	16,		64,		0x1000,		4 },
+		{ "extreme-phnum-32-be",	ELF_CLASS_32, ELF_DATA_BIG,		70000,	16,		64,		0x1000,		4 },
+		{ "extreme-shnum-64-le",	ELF_CLASS_64, ELF_DATA_LITTLE,	8,		70000,	64,		0x1000,		4 },
+		{ "extreme-shnum-32-be",	ELF_CLASS_32, ELF_DATA_BIG,		8,		70000,	64,		0x1000,		4 },
+	};
+
+	/* splitmix64; small, fast and the same everywhere. */
+	inline uint64_t next_random(uint64_t &state)
+	{
+		uint64_t value = (state += 0x9E3779B97F4A7C15);
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+		return value ^ (value >> 31);
+	}
+
+	/* Store `value` at `image[offset]` in the byte order of `Traits`. */
+	template<typename Traits, typename T>
+	inline void put_value(std::vector<uint8_t> &image, uint64_t offset, T value)
+	{
+		value = Traits::get(value);
+		memcpy(image.data() + offset, &value, sizeof(T));
+	}
+
+	template<typename Traits>
+	std::vector<uint8_t> make_image(const struct CorpusProfile &profile, uint64_t seed)
+	{
+		using Word = typename Traits::Word;
+		auto align = [] (uint64_t offset, uint64_t alignment) { return (offset + alignment - 1) & ~(alignment - 1); };
+
+		constexpr uint64_t base_address = 0x400000;
+		constexpr uint32_t build_id_size = 20;
+		constexpr uint32_t fixed_sections = 6;		/* null, `.note.gnu.build-id`, `.text`, `.symtab`, `.strtab`, `.shstrtab` */
+		const char section_names[] = "\0.note.gnu.build-id\0.text\0.symtab\0.strtab\0.shstrtab\0.bench.filler";
+		const uint32_t name_offsets[] = { 0, 1, 20, 26, 34, 42, 52 };
+
+		uint64_t random = seed;
+		uint32_t segment_amnt = profile.segment_amnt;
+		uint32_t section_amnt = profile.section_amnt;
+
+		/* Where everything goes. */
+		uint64_t segments = Traits::header_size;
+		uint64_t note = align(segments + (uint64_t) segment_amnt * Traits::program_header_size, 4);
+		uint64_t note_size = ELF_NOTE_HEADER_SIZE + 4 + build_id_size;
+		uint64_t text = align(note + note_size, 16);
+		uint64_t symbols = align(text + profile.payload_size, 8);
+		uint64_t symbols_size = (uint64_t) profile.symbol_amnt * Traits::symbol_size;
+		uint64_t strings = symbols + symbols_size;
+
+		std::vector<uint8_t> symbol_names(1, 0);
+		for(uint32_t i = 1; i < profile.symbol_amnt; i++)
+		{
+			char name[32];
+			int length = snprintf(name, sizeof(name), "bench_function_%u", i);
+			symbol_names.insert(symbol_names.end(), name, name + length + 1);
+		}
+
+		uint64_t names = strings + symbol_names.size();
+		uint64_t section_table = align(names + sizeof(section_names), 8);
+		uint64_t file_size = section_table + (uint64_t) section_amnt * Traits::section_header_size;
+
+		std::vector<uint8_t> image(file_size, 0);
+
+		/* The header. */
+		typename Traits::Header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.e_ident, "\x7F" "ELF", 4);
+		header.e_ident[4] = Traits::elf_class;
+		header.e_ident[5] = Traits::order == std::endian::little ? ELF_DATA_LITTLE : ELF_DATA_BIG;
+		header.e_ident[6] = ELF_CURRENT_VERSION;
+		header.e_type = Traits::get((uint16_t) ELF_file_types::EFileType);
+		header.e_machine = Traits::get((uint16_t) (Traits::elf_class == ELF_CLASS_64
+			? (Traits::order == std::endian::little ? ELF_machine_types::AMD_X86_64 : ELF_machine_types::PowerPC64)
+			: (Traits::order == std::endian::little ? ELF_machine_types::Intel80386 : ELF_machine_types::PowerPC)));
+		header.e_version = Traits::get((uint32_t) ELF_CURRENT_VERSION);
+		header.e_entry = Traits::get((Word) (base_address + text));
+		header.e_phoff = Traits::get((Word) segments);
+		header.e_shoff = Traits::get((Word) section_table);
+		header.e_ehsize = Traits::get((uint16_t) Traits::header_size);
+		header.e_phentsize = Traits::get((uint16_t) Traits::program_header_size);
+		header.e_phnum = Traits::get((uint16_t) (segment_amnt >= ELF_PH_EXTENDED_NUMBERING ? ELF_PH_EXTENDED_NUMBERING : segment_amnt));
+		header.e_shentsize = Traits::get((uint16_t) Traits::section_header_size);
+		/* 0xFF00 and up are reserved section indexes, so bigger tables go in section header 0. */
+		header.e_shnum = Traits::get((uint16_t) (section_amnt >= 0xFF00 ? 0 : section_amnt));
+		header.e_shstrndx = Traits::get((uint16_t) (section_amnt >= 0xFF00 ? ELF_SH_EXTENDED_INDEX : fixed_sections - 1));
+		memcpy(image.data(), &header, sizeof(header));
+
+		/* The program headers. */
+		for(uint32_t i = 0; i < segment_amnt; i++)
+		{
+			typename Traits::ProgramHeader segment;
+			memset(&segment, 0, sizeof(segment));
+
+			if(i == 0)
+			{
+				segment.p_type = Traits::get((uint32_t) SegmentTypes::ST_LOAD);
+				segment.p_flags = Traits::get((uint32_t) SegmentFlags::SF_READ | (uint32_t) SegmentFlags::SF_EXECUTE);
+				segment.p_vaddr = segment.p_paddr = Traits::get((Word) base_address);
+				segment.p_filesz = segment.p_memsz = Traits::get((Word) file_size);
+				segment.p_align = Traits::get((Word) 0x1000);
+			}
+			else if(i == 1)
+			{
+				segment.p_type = Traits::get((uint32_t) SegmentTypes::ST_NOTE);
+				segment.p_flags = Traits::get((uint32_t) SegmentFlags::SF_READ);
+				segment.p_offset = Traits::get((Word) note);
+				segment.p_vaddr = segment.p_paddr = Traits::get((Word) (base_address + note));
+				segment.p_filesz = segment.p_memsz = Traits::get((Word) note_size);
+				segment.p_align = Traits::get((Word) 4);
+			}
+
+			memcpy(image.data() + segments + (uint64_t) i * Traits::program_header_size, &segment, sizeof(segment));
+		}
+
+		/* The build ID note. */
+		put_value<Traits>(image, note, (uint32_t) 4);
+		put_value<Traits>(image, note + 4, build_id_size);
+		put_value<Traits>(image, note + 8, (uint32_t) 0x3);
+		memcpy(image.data() + note + ELF_NOTE_HEADER_SIZE, "GNU", 4);
+		for(uint32_t i = 0; i < build_id_size; i++)
+			image[note + ELF_NOTE_HEADER_SIZE + 4 + i] = next_random(random);
+
+		/* `.text`: anything will do, as long as it is not all zeroes. */
+		for(uint64_t i = 0; i + 8 <= profile.payload_size; i += 8)
+		{
+			uint64_t value = next_random(random);
+			memcpy(image.data() + text + i, &value, 8);
+		}
+
+		/* `.symtab` (after the null symbol) and `.strtab`. */
+		for(uint32_t i = 1, name = 1; i < profile.symbol_amnt; i++)
+		{
+			typename Traits::Symbol symbol;
+			memset(&symbol, 0, sizeof(symbol));
+
+			symbol.st_name = Traits::get((uint32_t) name);
+			symbol.st_info = 0x12;		/* global function */
+			symbol.st_shndx = Traits::get((uint16_t) 2);
+			symbol.st_value = Traits::get((Word) (base_address + text + (next_random(random) % (profile.payload_size / 16)) * 16));
+			symbol.st_size = Traits::get((Word) 16);
+
+			memcpy(image.data() + symbols + (uint64_t) i * Traits::symbol_size, &symbol, sizeof(symbol));
+			name += strlen((const char *) symbol_names.data() + name) + 1;
+		}
+		memcpy(image.data() + strings, symbol_names.data(), symbol_names.size());
+		memcpy(image.data() + names, section_names, sizeof(section_names));
+
+		/* The section headers; the fillers are empty and all share one name. */
+		for(uint32_t i = 0; i < section_amnt; i++)
+		{
+			typename Traits::SectionHeader section;
+			memset(&section, 0, sizeof(section));
+
+			switch(i)
+			{
+				case 0:
+					if(section_amnt >= 0xFF00)
+					{
+						section.sh_size = Traits::get((Word) section_amnt);
+						section.sh_link = Traits::get(fixed_sections - 1);
+					}
+					if(segment_amnt >= ELF_PH_EXTENDED_NUMBERING)
+						section.sh_info = Traits::get(segment_amnt);
+					break;
+				case 1:
+					section.sh_type = Traits::get((uint32_t) SectionTypes::SHT_NOTE);
+					section.sh_flags = Traits::get((Word) SectionFlags::SF_ALLOC);
+					section.sh_addr = Traits::get((Word) (base_address + note));
+					section.sh_offset = Traits::get((Word) note);
+					section.sh_size = Traits::get((Word) note_size);
+					section.sh_addralign = Traits::get((Word) 4);
+					break;
+				case 2:
+					section.sh_type = Traits::get((uint32_t) SectionTypes::SHT_PROGBITS);
+					section.sh_flags = Traits::get((Word) SectionFlags::SF_ALLOC | (Word) SectionFlags::SF_EXECINSTR);
+					section.sh_addr = Traits::get((Word) (base_address + text));
+					section.sh_offset = Traits::get((Word) text);
+					section.sh_size = Traits::get((Word) profile.payload_size);
+					section.sh_addralign = Traits::get((Word) 16);
+					break;
+				case 3:
+					section.sh_type = Traits::get((uint32_t) SectionTypes::SHT_SYMTAB);
+					section.sh_offset = Traits::get((Word) symbols);
+					section.sh_size = Traits::get((Word) symbols_size);
+					section.sh_link = Traits::get((uint32_t) 4);
+					section.sh_info = Traits::get((uint32_t) 1);		/* one past the last local symbol */
+					section.sh_addralign = Traits::get((Word) 8);
+					section.sh_entsize = Traits::get((Word) Traits::symbol_size);
+					break;
+				case 4:
+					section.sh_type = Traits::get((uint32_t) SectionTypes::SHT_STRTAB);
+					section.sh_offset = Traits::get((Word) strings);
+					section.sh_size = Traits::get((Word) symbol_names.size());
+					section.sh_addralign = Traits::get((Word) 1);
+					break;
+				case 5:
+					section.sh_type = Traits::get((uint32_t) SectionTypes::SHT_STRTAB);
+					section.sh_offset = Traits::get((Word) names);
+					section.sh_size = Traits::get((Word) sizeof(section_names));
+					section.sh_addralign = Traits::get((Word) 1);
+					break;
+				default:
+					section.sh_type = Traits::get((uint32_t) SectionTypes::SHT_PROGBITS);
+					section.sh_offset = Traits::get((Word) text);
+					section.sh_addralign = Traits::get((Word) 1);
+					break;
+			}
+
+			section.sh_name = Traits::get(name_offsets[i < fixed_sections ? i : fixed_sections]);
+			memcpy(image.data() + section_table + (uint64_t) i * Traits::section_header_size, &section, sizeof(section));
+		}
+
+		return image;
+	}
+
+	inline std::vector<uint8_t> make_image(const struct CorpusProfile &profile, uint64_t seed)
+	{
+		return ELF_dispatch(profile.elf_class, profile.elf_data, [&] <typename Traits> () {
+			return make_image<Traits>(profile, seed);
+		});
+	}
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include "bench.hpp"
+#include "corpus.hpp"
+#include <fcntl.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/* End to end numbers: writes the synthetic corpus, then runs the command line tool over it
+ * the way it gets used, and reports files/s, MB/s and the peak RSS of each run.
+ *
+ * Usage: end_to_end_bench <tool> <corpus directory>
+ * */
+
+/* How many times each run is repeated; the fastest one is reported. */
+#define BENCH_RUNS		3
+
+struct bench_file
+{
+	std::string	path;
+	uint64_t	size;
+};
+
+struct bench_result
+{
+	double		seconds;
+	long		peak_rss_kb;
+};
+
+/* Write every profile's copies under `directory`, each with its own seed. */
+static void make_corpus(const char *directory, std::vector<struct bench_file> &files)
+{
+	mkdir(directory, 0755);
+
+	for(uint32_t profile = 0; profile < sizeof(elf_bench::corpus_profiles) / sizeof(elf_bench::corpus_profiles[0]); profile++)
+	{
+		const struct elf_bench::CorpusProfile &corpus_profile = elf_bench::corpus_profiles[profile];
+
+		for(uint32_t copy = 0; copy < corpus_profile.copies; copy++)
+		{
+			std::vector<uint8_t> image = elf_bench::make_image(corpus_profile, (uint64_t) profile << 32 | copy);
+			std::string path = std::string(directory) + "/" + corpus_profile.name + "-" + std::to_string(copy) + ".elf";
+			int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+			ELF_ASSERT(fd >= 0,
+				"\nCould not write `%s`.\n", path.c_str())
+
+			ElfOutput::write_all(fd, (const char *) image.data(), image.size());
+			close(fd);
+			files.push_back({ path, image.size() });
+		}
+	}
+}
+
+/* Run `arguments` with its output thrown away; the RSS is that of the child alone. */
+static struct bench_result run_tool(const std::vector<std::string> &arguments)
+{
+	std::vector<char *> argv;
+	for(const auto &argument : arguments)
+		argv.push_back((char *) argument.c_str());
+	argv.push_back(nullptr);
+
+	auto start = std::chrono::steady_clock::now();
+	pid_t child = fork();
+
+	if(child == 0)
+	{
+		int null_fd = open("/dev/null", O_WRONLY);
+		dup2(null_fd, STDOUT_FILENO);
+		execv(argv[0], argv.data());
+		_exit(127);
+	}
+
+	int status = 0;
+	struct rusage usage;
+	wait4(child, &status, 0, &usage);
+	auto end = std::chrono::steady_clock::now();
+
+	ELF_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0,
+		"\n`%s` failed (status %X).\n", arguments[0].c_str(), status)
+
+	return { std::chrono::duration<double>(end - start).count(), usage.ru_maxrss };
+}
+
+/* Run the tool with `options` over every file in `files` whose name starts with `group`; with
+ * a `directory`, the tool finds them itself (with -r) instead.
+ * */
+static void bench_files(const char *tool, const char *name, const std::vector<std::string> &options,
+	const std::vector<struct bench_file> &files, const char *group, const char *directory = nullptr)
+{
+	std::vector<std::string> arguments = { tool };
+	uint64_t file_amnt = 0, total_size = 0;
+
+	arguments.insert(arguments.end(), options.begin(), options.end());
+	arguments.push_back(directory ? "-r" : "-f");
+	if(directory)
+		arguments.push_back(directory);
+
+	for(const auto &file : files)
+	{
+		if(file.path.find(group) == std::string::npos)
+			continue;
+
+		if(!directory)
+			arguments.push_back(file.path);
+		file_amnt++;
+		total_size += file.size;
+	}
+
+	struct bench_result best = { 1e30, 0 };
+	for(uint32_t i = 0; i < BENCH_RUNS; i++)
+	{
+		struct bench_result result = run_tool(arguments);
+		best.seconds = std::min(best.seconds, result.seconds);
+		best.peak_rss_kb = std::max(best.peak_rss_kb, result.peak_rss_kb);
+	}
+
+	double megabytes = total_size / 1e6;
+	printf("%-24s %-15s %6lu files %9.1f MB %9.3f s %10.0f files/s %9.1f MB/s %8.1f MB RSS\n",
+		name, group[0] ? group : "all", file_amnt, megabytes, best.seconds,
+		file_amnt / best.seconds, megabytes / best.seconds, best.peak_rss_kb / 1024.0);
+}
+
+int main(int args, char *argv[])
+{
+	ELF_ASSERT(args == 3,
+		"\nUsage: %s <tool> <corpus directory>\n", argv[0])
+
+	const char *tool = argv[1];
+	std::vector<struct bench_file> files;
+
+	make_corpus(argv[2], files);
+
+	/* Every group with the default report, then the other modes over the whole corpus. */
+	for(const char *group : { "small-", "large-", "extreme-phnum-", "extreme-shnum-", "" })
+		bench_files(tool, "report", {}, files, group);
+
+	bench_files(tool, "report (lazy)", { "-l" }, files, "");
+	bench_files(tool, "report (-A)", { "-A" }, files, "");
+	bench_files(tool, "ndjson", { "--format=ndjson" }, files, "");
+	bench_files(tool, "ndjson + symbols, notes", { "--format=ndjson", "-s", "-n" }, files, "");
+	bench_files(tool, "summary", { "--summary" }, files, "");
+	bench_files(tool, "scan + summary", { "--summary" }, files, "", argv[2]);
+
+	return 0;
+}
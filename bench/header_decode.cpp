@@ -0,0 +1,40 @@
+#include "bench.hpp"
+#include "legacy_decode.hpp"
+
+/* Before/after numbers for decoding the 52-byte ELF header out of memory. */
+
+/* A valid little endian, 32-bit executable header. */
+static const uint8_t elf32_header[ELF_HEADER_SIZE] = {
+	0x7F, 'E', 'L', 'F', 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x70, 0x10, 0x00, 0x00, 0x34, 0x00, 0x00, 0x00,
+	0xD4, 0x35, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x34, 0x00, 0x20, 0x00, 0x0B, 0x00, 0x28, 0x00,
+	0x1D, 0x00, 0x1C, 0x00
+};
+
+int main()
+{
+	const uint64_t iterations = 5000000;
+	ElfHeader::ELF_header legacy_header, header;
+
+	elf_legacy::get_elf_header(elf32_header, legacy_header);
+	ElfHeader::ELF_decode_header<Elf32LE>(elf32_header, header);
+	ELF_ASSERT(legacy_header.ELF_entry == header.ELF_entry && legacy_header.ELF_SH_offset == header.ELF_SH_offset,
+		"\nThe legacy and overlay decoders disagree.\n")
+
+	double before = elf_bench::ns_per_op([&] () {
+		elf_legacy::get_elf_header(elf32_header, legacy_header);
+		elf_bench::do_not_optimize(legacy_header);
+	}, iterations);
+
+	double after = elf_bench::ns_per_op([&] () {
+		ElfHeader::ELF_decode_header<Elf32LE>(elf32_header, header);
+		elf_bench::do_not_optimize(ElfHeader::ELF_validate_header(header));
+		elf_bench::do_not_optimize(header);
+	}, iterations);
+
+	printf("header decode (per-field reads):  %8.2f ns/op\n", before);
+	printf("header decode (overlay):          %8.2f ns/op\n", after);
+	printf("speedup:                          %8.2fx\n", before / after);
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+#ifndef ELF_LEGACY_DECODE_H
+#define ELF_LEGACY_DECODE_H
+#include <elf_header.hpp>
+using namespace elf_header;
+
+/* Frozen copy of the original per-field decoding path, kept only so the benchmarks
+ * have a "before" to compare against. Nothing outside of `bench/` uses this.
+ *
+ * The only change from the original is that the scratch buffers get one extra byte,
+ * since `read_binary` writes `data[bytes]`.
+ * */
+namespace elf_legacy
+{
+	struct LegacyDecoder
+	{
+		const uint8_t *image;
+		size_t seek_pos = 0;
+		size_t backup_seek_pos = 0;
+
+		uint8_t read_binary(uint8_t bytes, uint8_t *data)
+		{
+			if(bytes > 4)
+				bytes = 4;
+
+			uint8_t bytes_to_read = bytes;
+
+			memset(data, 0, bytes);
+			backup_seek_pos = seek_pos;
+
+			while(bytes > 0)
+			{
+				data[bytes] = image[seek_pos];
+
+				seek_pos++;
+				bytes--;
+			}
+
+			if(seek_pos - backup_seek_pos == 1)
+			{
+				data[0] = data[1];
+				data[1] = 0;
+			}
+
+			return bytes_to_read;
+		}
+
+		template<typename T>
+		T make_into_complete_value(uint8_t bytes, uint8_t *data)
+		{
+			T complete_value = 0;
+
+			complete_value |= data[sizeof(T)] & 0xFF;
+			complete_value = (complete_value << 8) | (data[sizeof(T) - 1] & 0xFF);
+
+			if(sizeof(T) == 2) goto end;
+
+			complete_value = (complete_value << 8) | (data[2] & 0xFF);
+			complete_value = (complete_value << 8) | (data[1] & 0xFF);
+
+			end:
+			return (T) complete_value;
+		}
+	};
+
+	template<typename T>
+	T revert_value(T value)
+	{
+		T old_value = value;
+		value ^= value;
+
+		switch(sizeof(T))
+		{
+			case 2: {
+				value |= (value << 0) | ((old_value >> 0) & 0xFF);
+				value = (value << 8) | ((old_value >> 8) & 0xFF);
+				break;
+			}
+			case 4: {
+				value |= (value << 0) | ((old_value >> 0) & 0xFF);
+				value = (value << 8) | ((old_value >> 8) & 0xFF);
+				value = (value << 8) | ((old_value >> 16) & 0xFF);
+				value = (value << 8) | ((old_value >> 24) & 0xFF);
+				break;
+			}
+			default: break;
+		}
+
+		return (T) value;
+	}
+
+	/* The original `ElfHeader::get_elf_header`, minus the validation. */
+	inline void get_elf_header(const uint8_t *image, ElfHeader::ELF_header &header)
+	{
+		LegacyDecoder decoder = { image };
+		uint8_t *read_in_data = nullptr;
+
+		const auto read = [&read_in_data, &decoder] (uint8_t size)
+		{
+			if(read_in_data)
+				delete[] read_in_data;
+
+			read_in_data = new uint8_t[size + 1];
+			decoder.read_binary(size, read_in_data);
+		};
+
+		read(4);
+		header.ELF_magic = decoder.make_into_complete_value<uint32_t> (4, read_in_data);
+
+		read(1);
+		header.ELF_type = read_in_data[0];
+		read(1);
+		header.ELF_endianess = read_in_data[0];
+		read(1);
+		header.ELF_version = read_in_data[0];
+
+		read(4);
+		read(4);
+		read(1);
+
+		read(2);
+		header.ELF_file_type = (decoder.make_into_complete_value<uint16_t> (2, read_in_data) >> 8) & 0xFF;
+		read(2);
+		header.ELF_machine_type = (decoder.make_into_complete_value<uint16_t> (2, read_in_data) >> 8) & 0xFF;
+
+		read(4);
+		header.ELF_version2 = (decoder.make_into_complete_value<uint32_t> (4, read_in_data) >> 24) & 0xFF;
+		read(4);
+		header.ELF_entry = revert_value<uint32_t> (decoder.make_into_complete_value<uint32_t> (4, read_in_data));
+		read(4);
+		header.ELF_PH_offset = revert_value<uint32_t> (decoder.make_into_complete_value<uint32_t> (4, read_in_data));
+		read(4);
+		header.ELF_SH_offset = revert_value<uint32_t> (decoder.make_into_complete_value<uint32_t> (4, read_in_data));
+		read(4);
+		header.ELF_flags = revert_value<uint32_t> (decoder.make_into_complete_value<uint32_t> (4, read_in_data));
+
+		read(2);
+		header.ELF_hsize = revert_value<uint16_t> (decoder.make_into_complete_value<uint16_t> (2, read_in_data));
+		read(2);
+		header.ELF_PH_entry_size = revert_value<uint16_t> (decoder.make_into_complete_value<uint16_t> (2, read_in_data));
+		read(2);
+		header.ELF_PH_entry_amnt = revert_value<uint16_t> (decoder.make_into_complete_value<uint16_t> (2, read_in_data));
+		read(2);
+		header.ELF_SH_size = revert_value<uint16_t> (decoder.make_into_complete_value<uint16_t> (2, read_in_data));
+		read(2);
+		header.ELF_SH_entry_amnt = revert_value<uint16_t> (decoder.make_into_complete_value<uint16_t> (2, read_in_data));
+		read(2);
+		header.ELF_SH_str_index = revert_value<uint16_t> (decoder.make_into_complete_value<uint16_t> (2, read_in_data));
+
+		delete[] read_in_data;
+	}
+}
+
+#endif
@@ -0,0 +1,178 @@
+#define ELF_BENCH_COUNT_ALLOCATIONS
+#include "bench.hpp"
+#include "corpus.hpp"
+#include "legacy_decode.hpp"
+#include <elf_program_header.hpp>
+#include <sys/mman.h>
+using namespace elf_program_header;
+
+/* ns/op and allocations/op of the field decoding primitives, old and new, and of the header and
+ * program header table decoders, on synthetic images of each class and byte order.
+ *
+ * Every result is one JSON object per line, so runs on different commits can be diffed or
+ * loaded as they are: `benchmark`, `image`, `bytes` (of the image), `entries` (program
+ * headers decoded per op), `iterations`, `ns_per_op` and `allocations_per_op`.
+ * */
+
+/* Re-decodes on every call; the decoders only decode the first time they are asked to.
+ * The table decoded before is dropped from the arena first, so every call decodes into the same memory.
+ * */
+class BenchProgramHeader : public ElfProgramHeader
+{
+	/* Right after the header, where the table goes. */
+	ElfArena::mark table_mark;
+
+public:
+	BenchProgramHeader(int fd, int8_t &filename)
+		: ElfProgramHeader(fd, filename)
+	{
+		table_mark = edecoder->ELF_get_arena().get_mark();
+	}
+
+	void decode_header()
+	{
+		header_decoded = false;
+		get_elf_header();
+	}
+
+	void decode_program_header_table()
+	{
+		edecoder->ELF_get_arena().rewind(table_mark);
+		pheader_decoded = false;
+		get_program_header_table();
+	}
+};
+
+/* The images the decoders run on: every class and byte order, with more and more segments. */
+static const struct elf_bench::CorpusProfile image_profiles[] = {
+	{ "8-segments-32-le",		ELF_CLASS_32, ELF_DATA_LITTLE,	8,		16,		64,		0x1000,		1 },
+	{ "8-segments-32-be",		ELF_CLASS_32, ELF_DATA_BIG,		8,		16,		64,		0x1000,		1 },
+	{ "8-segments-64-le",		ELF_CLASS_64, ELF_DATA_LITTLE,	8,		16,		64,		0x1000,		1 },
+	{ "8-segments-64-be",		ELF_CLASS_64, ELF_DATA_BIG,		8,		16,		64,		0x1000,		1 },
+	{ "512-segments-32-le",		ELF_CLASS_32, ELF_DATA_LITTLE,	512,	16,		64,		0x10000,	1 },
+	{ "512-segments-32-be",		ELF_CLASS_32, ELF_DATA_BIG,		512,	16,		64,		0x10000,	1 },
+	{ "512-segments-64-le",		ELF_CLASS_64, ELF_DATA_LITTLE,	512,	16,		64,		0x10000,	1 },
+	{ "512-segments-64-be",		ELF_CLASS_64, ELF_DATA_BIG,		512,	16,		64,		0x10000,	1 },
+	{ "70000-segments-32-le",	ELF_CLASS_32, ELF_DATA_LITTLE,	70000,	16,		64,		0x100000,	1 },
+	{ "70000-segments-64-be",	ELF_CLASS_64, ELF_DATA_BIG,		70000,	16,		64,		0x100000,	1 },
+};
+
+static void print_measurement(const char *benchmark, const char *image, size_t bytes, uint32_t entries, const struct elf_bench::Measurement &measurement)
+{
+	printf("{\"benchmark\":\"%s\",\"image\":\"%s\",\"bytes\":%lu,\"entries\":%u,\"iterations\":%lu,\"ns_per_op\":%.3f,\"allocations_per_op\":%.3f}\n",
+		benchmark, image, bytes, entries, measurement.iterations, measurement.ns_per_op, measurement.allocations_per_op);
+	fflush(stdout);
+}
+
+/* The legacy primitives only ever handled the first 52 bytes of 32-bit files. */
+static void bench_legacy_primitives(const std::vector<uint8_t> &image, const char *name)
+{
+	elf_legacy::LegacyDecoder decoder = { image.data() };
+	uint8_t data[5];
+	ElfHeader::ELF_header header;
+
+	for(uint8_t bytes : { 1, 2, 4 })
+	{
+		char benchmark[32];
+		snprintf(benchmark, sizeof(benchmark), "legacy_read_binary_%u", bytes);
+
+		print_measurement(benchmark, name, image.size(), 0, elf_bench::measure([&] () {
+			/* Stay within the header. */
+			decoder.seek_pos &= 0x1F;
+			elf_bench::do_not_optimize(decoder.read_binary(bytes, data));
+			elf_bench::do_not_optimize(data);
+		}));
+	}
+
+	decoder.seek_pos = 0x18;
+	decoder.read_binary(4, data);
+	print_measurement("legacy_make_into_complete_value_16", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_bench::do_not_optimize(decoder.make_into_complete_value<uint16_t>(2, data));
+	}));
+	print_measurement("legacy_make_into_complete_value_32", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_bench::do_not_optimize(decoder.make_into_complete_value<uint32_t>(4, data));
+	}));
+
+	uint32_t value = 0x12345678;
+	print_measurement("legacy_revert_value_16", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_bench::do_not_optimize(elf_legacy::revert_value<uint16_t>(value));
+		elf_bench::do_not_optimize(value);
+	}));
+	print_measurement("legacy_revert_value_32", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_bench::do_not_optimize(elf_legacy::revert_value<uint32_t>(value));
+		elf_bench::do_not_optimize(value);
+	}));
+
+	print_measurement("legacy_get_elf_header", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_legacy::get_elf_header(image.data(), header);
+		elf_bench::do_not_optimize(header);
+	}));
+}
+
+/* What replaced the three legacy primitives: one read in the file's byte order. */
+static void bench_read_value(const std::vector<uint8_t> &image, const char *name)
+{
+	const uint8_t *data = image.data() + 0x18;
+
+	print_measurement("read_value_16_le", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_bench::do_not_optimize(ELF_read_value<uint16_t, std::endian::little>(data));
+		elf_bench::do_not_optimize(data);
+	}));
+	print_measurement("read_value_32_be", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_bench::do_not_optimize(ELF_read_value<uint32_t, std::endian::big>(data));
+		elf_bench::do_not_optimize(data);
+	}));
+	print_measurement("read_value_64_be", name, image.size(), 0, elf_bench::measure([&] () {
+		elf_bench::do_not_optimize(ELF_read_value<uint64_t, std::endian::big>(data));
+		elf_bench::do_not_optimize(data);
+	}));
+}
+
+/* The decoders, on the image kept in memory (`memfd`) and mapped like any file would be. */
+static void bench_decoders(const std::vector<uint8_t> &image, const char *name)
+{
+	int fd = memfd_create(name, MFD_CLOEXEC);
+
+	ELF_ASSERT(fd >= 0 && write(fd, image.data(), image.size()) == (ssize_t) image.size(),
+		"\nCould not put `%s` in memory.\n", name)
+
+	BenchProgramHeader *decoder = new BenchProgramHeader(fd, *(int8_t *) name);
+	uint32_t entries = decoder->get_program_header_amnt();
+
+	print_measurement("get_elf_header", name, image.size(), 0, elf_bench::measure([&] () {
+		decoder->decode_header();
+	}));
+	print_measurement("get_program_header_table", name, image.size(), entries, elf_bench::measure([&] () {
+		decoder->decode_program_header_table();
+		elf_bench::do_not_optimize(decoder->get_program_header(entries - 1));
+	}));
+	/* What decoding another file costs once the decoder has been through one: mapping it and decoding its tables again. */
+	print_measurement("reset_and_decode", name, image.size(), entries, elf_bench::measure([&] () {
+		decoder->reset(fd, *(int8_t *) name);
+		decoder->get_program_header_table();
+		elf_bench::do_not_optimize(decoder->get_program_header(entries - 1));
+	}));
+
+	delete decoder;
+	close(fd);
+}
+
+int main()
+{
+	for(const auto &profile : image_profiles)
+	{
+		std::vector<uint8_t> image = elf_bench::make_image(profile, 1);
+
+		/* The primitives do not care about the size of the image, so they only run once per class and byte order. */
+		if(profile.segment_amnt == 8)
+		{
+			if(profile.elf_class == ELF_CLASS_32 && profile.elf_data == ELF_DATA_LITTLE)
+				bench_legacy_primitives(image, profile.name);
+			bench_read_value(image, profile.name);
+		}
+
+		bench_decoders(image, profile.name);
+	}
+
+	return 0;
+}
@@ -4,6 +4,14 @@
 #include <stdlib.h>
 #include <cstring>
 #include <stdint.h>
+#include <cstddef>
+#include <bit>
+#include <vector>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
 
 #ifdef NULL
 #undef NULL
@@ -33,171 +41,613 @@ enum class ELF_parts: uint8_t
 	ELF_SectionHT	= 0x3,		/* Section Header Table */
 };
 
+/* Reverse the byte order of `value`; compiles down to a single `bswap`. */
 template<typename T>
-	requires (std::is_same<T, uint16_t>::value
-		|| std::is_same<T, uint32_t>::value)
-		&& (!std::is_same<T, uint8_t>::value)
-T revert_value(T value)
+	requires std::is_integral<T>::value
+constexpr T ELF_byte_swap(T value)
 {
-	T old_value = value;
-	value ^= value;
+	if constexpr(sizeof(T) == 2)
+		return (T) __builtin_bswap16((uint16_t) value);
+	else if constexpr(sizeof(T) == 4)
+		return (T) __builtin_bswap32((uint32_t) value);
+	else if constexpr(sizeof(T) == 8)
+		return (T) __builtin_bswap64((uint64_t) value);
 
-	switch(sizeof(T))
+	return value;
+}
+
+/* Read a `T` stored in `order` byte order at `source`.
+ * `order` is known at compile time, so this is a single load, plus a `bswap` when the
+ * file's byte order is not the host's. `source` must already be known to be in bounds.
+ * */
+template<typename T, std::endian order>
+	requires std::is_integral<T>::value
+inline T ELF_read_value(const uint8_t *source)
+{
+	T value;
+	memcpy(&value, source, sizeof(T));
+
+	if constexpr(order != std::endian::native && sizeof(T) > 1)
+		value = ELF_byte_swap(value);
+
+	return value;
+}
+
+/* All possible errors to encounter. */
+enum class ELF_errors: uint8_t
+{
+	Invalid_ELF_Header 		= 0x0,
+	Invalid_ELF_Section		= 0x1,
+	Invalid_ELF_SectionHT	= 0x2,
+	NoError					= 0x3,
+	Truncated_ELF_Binary	= 0x4,		/* Something the file points at is past its end. */
+	Read_Failed				= 0x5,		/* `pread` failed (or the file shrank) in lazy mode. */
+	Invalid_ELF_Ident		= 0x6,		/* Not an ELF binary file, or one of a class/byte order/version we do not know. */
+	Invalid_ELF_PHeaderT	= 0x7,		/* Program Header Table */
+	Invalid_ELF_Symbols		= 0x8,
+	Invalid_ELF_Hash		= 0x9,
+	Invalid_ELF_Relocations	= 0xA,
+	Invalid_ELF_Dynamic		= 0xB,
+	Open_Failed				= 0xC
+};
+
+static uint8_t *get_ELF_error_name(ELF_errors error)
+{
+	switch(error)
 	{
-		case 2: {
-			value |= (value << 0) | ((old_value >> 0) & 0xFF);
-			value = (value << 8) | ((old_value >> 8) & 0xFF);
-			break;
-		}
-		case 4: {
-			value |= (value << 0) | ((old_value >> 0) & 0xFF);
-			value = (value << 8) | ((old_value >> 8) & 0xFF);
-			value = (value << 8) | ((old_value >> 16) & 0xFF);
-			value = (value << 8) | ((old_value >> 24) & 0xFF);
-			break;
-		}
+		case ELF_errors::Invalid_ELF_Header: return (uint8_t *) "Invalid Header";break;
+		case ELF_errors::Invalid_ELF_Section: return (uint8_t *) "Invalid Section";break;
+		case ELF_errors::Invalid_ELF_SectionHT: return (uint8_t *) "Invalid Section Header Table";break;
+		case ELF_errors::NoError: return (uint8_t *) "No Error";break;
+		case ELF_errors::Truncated_ELF_Binary: return (uint8_t *) "Truncated ELF Binary";break;
+		case ELF_errors::Read_Failed: return (uint8_t *) "Read Failed";break;
+		case ELF_errors::Invalid_ELF_Ident: return (uint8_t *) "Not An ELF Binary";break;
+		case ELF_errors::Invalid_ELF_PHeaderT: return (uint8_t *) "Invalid Program Header Table";break;
+		case ELF_errors::Invalid_ELF_Symbols: return (uint8_t *) "Invalid Symbol Table";break;
+		case ELF_errors::Invalid_ELF_Hash: return (uint8_t *) "Invalid Hash Table";break;
+		case ELF_errors::Invalid_ELF_Relocations: return (uint8_t *) "Invalid Relocation Section";break;
+		case ELF_errors::Invalid_ELF_Dynamic: return (uint8_t *) "Invalid Dynamic Section";break;
+		case ELF_errors::Open_Failed: return (uint8_t *) "Could Not Open";break;
 		default: break;
 	}
 
-	return (T) value;
+	return (uint8_t *) "Unknown Error";
 }
 
+/* What the decoders hand back: a `T`, or the reason there is none.
+ * A broken file is just another value to check (there is no `std::expected` to lean on yet), so
+ * nothing on the decode path throws or exits; whoever decodes many files reports it and moves on.
+ * */
+template<typename T>
+class ElfResult
+{
+	T result_value;
+	ELF_errors result_error;
+
+public:
+	ElfResult(T value)
+		: result_value(value), result_error(ELF_errors::NoError)
+	{}
+	ElfResult(ELF_errors error)
+		: result_value(), result_error(error)
+	{}
+
+	bool has_value() const { return result_error == ELF_errors::NoError; }
+	explicit operator bool() const { return has_value(); }
+	ELF_errors error() const { return result_error; }
+
+	/* Only meaningful with `has_value()`. */
+	T &value() { return result_value; }
+	T &operator*() { return result_value; }
+	T *operator->() { return &result_value; }
+};
+
+/* Just whether it worked. */
+template<>
+class ElfResult<void>
+{
+	ELF_errors result_error;
+
+public:
+	ElfResult()
+		: result_error(ELF_errors::NoError)
+	{}
+	ElfResult(ELF_errors error)
+		: result_error(error)
+	{}
+
+	bool has_value() const { return result_error == ELF_errors::NoError; }
+	explicit operator bool() const { return has_value(); }
+	ELF_errors error() const { return result_error; }
+};
+
+using ElfStatus = ElfResult<void>;
+
+/* Hand the error in `status` (an `ElfStatus` or any `ElfResult`) up to the caller. */
+#define ELF_TRY(status)							\
+{												\
+	auto ELF_try_status = (status);				\
+	if(!ELF_try_status)							\
+		return ELF_try_status.error();			\
+}
+
+/* A range of the file image that has been checked, once, to be entirely within the file.
+ * Reads inside it are not checked again; they are a plain load (plus a `bswap`), so a table
+ * decoder checks its table once up front and then costs the same as reading the image unchecked.
+ * Anything inside that was not part of that check (offsets and sizes read from the table itself)
+ * goes through `fits` or `subspan` first.
+ * */
+class ElfSpan
+{
+	const uint8_t *span_data;
+	uint64_t span_size;
+
+public:
+	ElfSpan()
+		: span_data(nullptr), span_size(0)
+	{}
+	ElfSpan(const uint8_t *data, uint64_t size)
+		: span_data(data), span_size(size)
+	{}
+
+	/* Whether `count` entries of `entry_size` bytes at `offset` are within `size` bytes.
+	 * `offset + count * entry_size` is never computed, so no value of any of them can overflow the check.
+	 * */
+	static constexpr bool range_fits(uint64_t size, uint64_t offset, uint64_t count, uint64_t entry_size)
+	{
+		return offset <= size && (entry_size == 0 || count <= (size - offset) / entry_size);
+	}
+
+	bool fits(uint64_t offset, uint64_t count, uint64_t entry_size = 1) const { return range_fits(span_size, offset, count, entry_size); }
+
+	ElfResult<ElfSpan> subspan(uint64_t offset, uint64_t count, uint64_t entry_size = 1) const
+	{
+		if(!fits(offset, count, entry_size))
+			return ELF_errors::Truncated_ELF_Binary;
+
+		return ElfSpan(span_data + offset, count * entry_size);
+	}
+
+	/* Unchecked; only for offsets the span was checked to hold. */
+	const uint8_t *at(uint64_t offset) const { return span_data + offset; }
+	const uint8_t *entry(uint64_t index, uint64_t entry_size) const { return span_data + index * entry_size; }
+
+	template<typename T, std::endian order>
+		requires std::is_integral<T>::value
+	T read(uint64_t offset) const
+	{
+		return ELF_read_value<T, order>(span_data + offset);
+	}
+
+	const uint8_t *data() const { return span_data; }
+	uint64_t size() const { return span_size; }
+	bool empty() const { return span_size == 0; }
+};
+
+/* How the ELF binary file gets brought into memory. */
+enum class ELF_load_modes: uint8_t
+{
+	Mapped	= 0x0,		/* Map the whole file; pages are read in as they are touched. */
+	Lazy	= 0x1		/* Only read (`pread`) the byte ranges the decoders ask for. */
+};
+
+/* Size of each block of an `ElfArena`; enough for the tables of most files. */
+#define ELF_ARENA_BLOCK_SIZE		0x10000
+/* Most an `ElfArena` holds on to between files, so one huge file does not tie its memory up for the rest of the run. */
+#define ELF_ARENA_MAX_KEPT			0x1000000
+
+/* Bump allocator for everything decoded out of one file.
+ * The decoders take their tables (and, in lazy mode, the ranges of the file that get read in)
+ * out of it one after the other, so what gets traversed together lies together, and nothing is
+ * freed on its own: `release` drops all of it at once, when the file is done. The blocks are
+ * kept for the next file; if a file needed more than one, the next file gets a single block as
+ * big as all of them. Nothing allocated here gets destructed.
+ * */
+class ElfArena
+{
+public:
+	/* How far the arena had been allocated from, for `rewind`. */
+	struct mark
+	{
+		size_t		block_index;
+		size_t		block_used;
+	};
+
+private:
+	struct block
+	{
+		uint8_t		*data;
+		size_t		size;
+	};
+
+	std::vector<struct block> blocks;
+	size_t block_index;				/* the block being allocated from */
+	size_t block_used;
+	size_t next_block_size;
+
+	void *allocate_bytes(size_t size, size_t alignment)
+	{
+		for(; block_index < blocks.size(); block_index++, block_used = 0)
+		{
+			struct block &current = blocks[block_index];
+			size_t start = (block_used + alignment - 1) & ~(alignment - 1);
+
+			if(start <= current.size && size <= current.size - start)
+			{
+				block_used = start + size;
+				return current.data + start;
+			}
+		}
+
+		/* `new[]` is aligned for any of the decoded structures. */
+		size_t block_size = std::max(next_block_size, size);
+		blocks.push_back({ new uint8_t[block_size], block_size });
+		block_used = size;
+
+		return blocks.back().data;
+	}
+
+	void free_blocks()
+	{
+		for(auto &current : blocks)
+			delete[] current.data;
+		blocks.clear();
+	}
+
+public:
+	ElfArena()
+		: block_index(0), block_used(0), next_block_size(ELF_ARENA_BLOCK_SIZE)
+	{}
+
+	ElfArena(const ElfArena &) = delete;
+	ElfArena &operator=(const ElfArena &) = delete;
+
+	/* Room for `count` `T`s, uninitialized; it stays until `release`. */
+	template<typename T>
+		requires std::is_trivially_destructible<T>::value
+	T *allocate(size_t count)
+	{
+		return (T *) allocate_bytes(count * sizeof(T), alignof(T));
+	}
+
+	struct mark get_mark() { return { block_index, block_used }; }
+
+	/* Everything allocated since `position` is gone; what came before stays. */
+	void rewind(const struct mark &position)
+	{
+		block_index = position.block_index;
+		block_used = position.block_used;
+	}
+
+	/* Everything allocated so far is gone. */
+	void release()
+	{
+		size_t total_size = 0;
+		for(const auto &current : blocks)
+			total_size += current.size;
+
+		if(blocks.size() > 1 || total_size > ELF_ARENA_MAX_KEPT)
+		{
+			free_blocks();
+			next_block_size = std::clamp<size_t>(total_size, ELF_ARENA_BLOCK_SIZE, ELF_ARENA_MAX_KEPT);
+		}
+
+		block_index = 0;
+		block_used = 0;
+	}
+
+	~ElfArena()
+	{
+		free_blocks();
+	}
+};
+
+/* Growable array in an `ElfArena`, for tables whose size is only known once they are decoded.
+ * Growing moves it elsewhere in the arena (the old room is only reclaimed with the rest), and it
+ * goes with the arena, so whatever holds one `reset`s it whenever the arena is released.
+ * */
+template<typename T>
+	requires std::is_trivially_copyable<T>::value
+class ElfArenaArray
+{
+	ElfArena *arena;
+	T *array_data;
+	size_t array_size;
+	size_t array_capacity;
+
+public:
+	ElfArenaArray(ElfArena &owner)
+		: arena(&owner), array_data(nullptr), array_size(0), array_capacity(0)
+	{}
+
+	void push_back(const T &value)
+	{
+		if(array_size == array_capacity)
+		{
+			size_t capacity = std::max<size_t>(array_capacity * 2, 16);
+			T *grown = arena->allocate<T>(capacity);
+
+			if(array_size > 0)
+				memcpy((void *) grown, array_data, array_size * sizeof(T));
+			array_data = grown;
+			array_capacity = capacity;
+		}
+
+		array_data[array_size++] = value;
+	}
+
+	/* Empty, keeping the room it has in the arena. */
+	void clear() { array_size = 0; }
+	/* Empty, with no room in the arena; for after the arena is released. */
+	void reset() { array_data = nullptr; array_size = array_capacity = 0; }
+
+	size_t size() const { return array_size; }
+	bool empty() const { return array_size == 0; }
+
+	T &operator[](size_t index) { return array_data[index]; }
+	const T &operator[](size_t index) const { return array_data[index]; }
+	T *begin() { return array_data; }
+	T *end() { return array_data + array_size; }
+	const T *begin() const { return array_data; }
+	const T *end() const { return array_data + array_size; }
+};
+
 /* Common functionality to be found in each "step" of decoding the ELF binary file. */
 class ElfDecoder
 {
 public:
-	/* Only used for `ELF_read_binary`. */
-	struct placeholder
+	/* A byte range of the file that has been read into memory. */
+	struct ELF_range
 	{
-		placeholder() = default;
-
-		~placeholder() = default;
+		size_t					offset;
+		std::vector<uint8_t>	data;
 	};
-	struct placeholder *pholder = nullptr;
 
 protected:
-	FILE *bin = nullptr;
-	uint8_t *ELF_binary = nullptr;
-	size_t seek_pos;
-	size_t backup_seek_pos;
+	int bin = -1;
 
-public:
-	template<typename T = placeholder>
-		requires std::is_class<T>::value
-	uint8_t ELF_read_binary(uint8_t &bytes, uint8_t *data, T &structure)
-	{
-		/* Will only read, max, 4 bytes at a time. */
-		if(bytes > 4)
-			bytes = 4;
-			
-		/* Keep track of how many bytes we are supposed to read in. */
-		uint8_t bytes_to_read = bytes;
-
-		if(bytes == NULL)
+	/* Read-only view of the whole ELF binary file.
+	 * When the file can be mapped, `ELF_binary` points directly into the mapping and
+	 * pages are only brought in once a decoder touches them. Otherwise (pipes, character
+	 * devices, procfs files...) the file is read into `ELF_fallback_buffer` and
+	 * `ELF_binary` points into that.
+	 * */
+	const uint8_t *ELF_binary = nullptr;
+	size_t ELF_binary_size;
+	bool ELF_mapped;
+	std::vector<uint8_t> ELF_fallback_buffer;
+
+	/* A byte range of the file that is in memory, in `ELF_arena` or in one of `ELF_adopted_ranges`. */
+	struct ELF_loaded_range
+	{
+		size_t			offset;
+		size_t			size;
+		const uint8_t	*data;
+	};
+
+	/* Everything decoded out of the current file is allocated from here, and released with it. */
+	ElfArena ELF_arena;
+
+	/* With `ELF_load_modes::Lazy`, `ELF_binary` stays `nullptr` and each byte range that
+	 * gets loaded is kept until the decoder is reset or deleted. Ranges read in here go in
+	 * the arena; the ones read in elsewhere are kept in `ELF_adopted_ranges`.
+	 * */
+	ElfArenaArray<struct ELF_loaded_range> ELF_loaded_ranges;
+	std::vector<struct ELF_range> ELF_adopted_ranges;
+	ELF_load_modes ELF_load_mode;
+
+	void ELF_release_binary()
+	{
+		if(ELF_mapped) munmap((void *) ELF_binary, ELF_binary_size);
+		ELF_binary = nullptr;
+		ELF_binary_size = 0;
+		ELF_mapped = false;
+	}
+
+	void ELF_map_binary()
+	{
+		struct stat file_stats;
+
+		if(fstat(bin, &file_stats) == 0 && S_ISREG(file_stats.st_mode) && file_stats.st_size > 0)
 		{
-			/* `nullptr` check. */
-			ELF_ASSERT(!(std::is_same<T, placeholder>::value),
-				"\nCannot read memory into a nullptr.\n")
-
-			fseek(bin, seek_pos, SEEK_SET);
-			ELF_ASSERT(fread(&structure, 1, sizeof(T), bin) == sizeof(T),
-				"\nThere was an error reading in the needed %lX (%ld) bytes.\n",
-				sizeof(T), sizeof(T))
-				
-			return NULL;
+			void *mapping = mmap(nullptr, file_stats.st_size, PROT_READ, MAP_PRIVATE, bin, 0);
+
+			if(mapping != MAP_FAILED)
+			{
+				ELF_binary = (const uint8_t *) mapping;
+				ELF_binary_size = file_stats.st_size;
+				ELF_mapped = true;
+
+				return;
+			}
 		}
 
-		/* Make sure `data` is not `nullptr`. */
-		ELF_ASSERT(data != nullptr,
-			"\nCannot read memory into a nullptr.\n")
+		/* The file cannot be mapped, so read it in chunks until EOF.
+		 * The size is not known up front for non-regular files, so we cannot rely on `ftell`.
+		 * */
+		uint8_t chunk[4096];
+		ssize_t read_in;
+
+		while((read_in = read(bin, chunk, sizeof(chunk))) != 0)
+		{
+			if(read_in < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				break;
+			}
+
+			ELF_fallback_buffer.insert(ELF_fallback_buffer.end(), chunk, chunk + read_in);
+		}
 
-		/* Zero out all memory. */
-		memset(data, 0, bytes);
+		ELF_binary = ELF_fallback_buffer.data();
+		ELF_binary_size = ELF_fallback_buffer.size();
+		ELF_mapped = false;
+	}
 
-		/* Save the "last state" of the previous seek position. */
-		backup_seek_pos = seek_pos;
+	/* Lazy mode only needs the size of the file, nothing gets read in until it is asked for.
+	 * Anything that cannot be read with `pread` (pipes etc.) gets read in entirely instead.
+	 * */
+	void ELF_open_lazily()
+	{
+		struct stat file_stats;
 
-		while(bytes > 0)
+		if(fstat(bin, &file_stats) == 0 && S_ISREG(file_stats.st_mode))
 		{
-			data[bytes] = ELF_binary[seek_pos];
-				
-			seek_pos++;
-			bytes--;
+			ELF_binary_size = file_stats.st_size;
+			return;
 		}
 
-		/* If we are reading in only a single byte, go ahead and make sure the first index stores the value that gets read in. */
-		if(seek_pos - backup_seek_pos == 1)
+		ELF_load_mode = ELF_load_modes::Mapped;
+		ELF_map_binary();
+	}
+
+	ElfResult<const uint8_t *> ELF_lazy_data_at(size_t offset, size_t length)
+	{
+		for(const auto &range : ELF_loaded_ranges)
+			if(offset >= range.offset && offset + length <= range.offset + range.size)
+				return range.data + (offset - range.offset);
+
+		/* Should the read fail, the room is only reclaimed with the rest of the arena. */
+		uint8_t *data = ELF_arena.allocate<uint8_t>(length);
+		size_t read_in = 0;
+
+		while(read_in < length)
 		{
-			data[0] = data[1];
-			data[1] = 0;
+			ssize_t amount = pread(bin, data + read_in, length - read_in, offset + read_in);
+
+			if(amount <= 0)
+				return ELF_errors::Read_Failed;
+
+			read_in += amount;
 		}
 
-		/* Make sure we read in the correct amount. */
-		ELF_ASSERT(seek_pos - backup_seek_pos == bytes_to_read,
-			"\nA very unknown error ocurred where the seek position did not increment by %d bytes.\n",
-			bytes)
-		return bytes_to_read;
+		ELF_loaded_ranges.push_back({ offset, length, data });
+		return (const uint8_t *) data;
 	}
 
-	/* Since the above function reads in the data backwards,
-	 * this function will "correct" the data.
-	 *
-	 * With values other than the 4-byte magic number, this will create
-	 * the wrong value. For example, we can read in a value of `0x6`, and
-	 * if we wanted to convert it to a 32-bit number via this function
-	 * it will be `0x60000000`. I would fix this, however, the following
-	 * code works miraculously with only the 4-byte magic number
-	 * at the beginning of the ELF file. With that, the following code
-	 * is "as-is" and the function `revert_value` exists to correct
-	 * all values this function returns except the 4-byte magic number.
-	 *
-	 * Old Requires:
-	 *	requires (std::is_same<T, uint16_t>::value
-	 *		|| std::is_same<T, uint32_t>::value)
-	 *		&& (!std::is_same<T, uint8_t>::value)
+public:
+	/* Get a pointer to `length` bytes at `offset` in the file, or `Truncated_ELF_Binary` if the range is not all within the file. */
+	ElfResult<const uint8_t *> ELF_data_at(size_t offset, size_t length)
+	{
+		if(!ElfSpan::range_fits(ELF_binary_size, offset, length, 1))
+			return ELF_errors::Truncated_ELF_Binary;
+
+		if(ELF_load_mode == ELF_load_modes::Lazy)
+			return ELF_lazy_data_at(offset, length);
+
+		return ELF_binary + offset;
+	}
+
+	/* Whether a table of `count` entries of `entry_size` bytes at `offset` is within the file; nothing is read in. */
+	bool ELF_table_fits(uint64_t offset, uint64_t count, uint64_t entry_size)
+	{
+		return ElfSpan::range_fits(ELF_binary_size, offset, count, entry_size);
+	}
+
+	/* The table of `count` entries of `entry_size` bytes at `offset`, checked to be within the file
+	 * as a whole (and read in, in lazy mode), so its entries can be read without any more checks.
 	 *
+	 * Every table decoder goes the same way: the table is decoded the first time it is asked for,
+	 * with the class and byte order picked once for all of it (`ELF_dispatch`), and fetched here up
+	 * front. Each entry is then copied out once (`overlay`) and its fields put in the host's byte
+	 * order. A table that fails any of that is left empty rather than half decoded.
 	 * */
-	template<typename T>
-		requires (std::is_integral<T>::value)
-			&& (!std::is_same<T, uint8_t>::value)
-	T make_into_complete_value(uint8_t bytes, uint8_t *data)
+	ElfResult<ElfSpan> ELF_table_at(uint64_t offset, uint64_t count, uint64_t entry_size)
 	{
-		T complete_value = 0;
-			
-		complete_value |= data[sizeof(T)] & 0xFF;
-		complete_value = (complete_value << 8) | (data[sizeof(T) - 1] & 0xFF);
+		if(!ELF_table_fits(offset, count, entry_size))
+			return ELF_errors::Truncated_ELF_Binary;
 
-		if(sizeof(T) == 2) goto end;
+		ElfResult<const uint8_t *> data = ELF_data_at(offset, count * entry_size);
+		if(!data)
+			return data.error();
 
-		complete_value = (complete_value << 8) | (data[2] & 0xFF);
-		complete_value = (complete_value << 8) | (data[1] & 0xFF);
+		return ElfSpan(*data, count * entry_size);
+	}
 
-		end:
-		return (T) complete_value;
+	/* Let the decoder know a whole table is about to be read.
+	 * In lazy mode this reads the entire range with one `pread`, so the individual field
+	 * reads that follow are served from memory. The range is clipped to the end of the file.
+	 * */
+	void ELF_load_range(size_t offset, size_t length)
+	{
+		if(ELF_load_mode != ELF_load_modes::Lazy || offset >= ELF_binary_size)
+			return;
+
+		if(length > ELF_binary_size - offset)
+			length = ELF_binary_size - offset;
+
+		/* Should the read fail, the `ELF_data_at` that comes next reports it. */
+		ELF_lazy_data_at(offset, length);
 	}
 
-	template<typename T>
+	/* Hand over byte ranges that were already read in elsewhere (e.g. by `elf_async::ElfAsyncReader`),
+	 * so that lazy mode serves them from memory instead of reading them in again.
+	 * */
+	void ELF_adopt_ranges(std::vector<struct ELF_range> &ranges)
+	{
+		if(ELF_load_mode != ELF_load_modes::Lazy)
+			return;
+
+		/* Moving the vectors keeps their buffers where they are. */
+		for(auto &range : ranges)
+		{
+			ELF_loaded_ranges.push_back({ range.offset, range.data.size(), range.data.data() });
+			ELF_adopted_ranges.push_back(std::move(range));
+		}
+		ranges.clear();
+	}
+
+	size_t ELF_get_binary_size() { return ELF_binary_size; }
+	/* Whatever is allocated from it is gone once the decoder is reset. */
+	ElfArena &ELF_get_arena() { return ELF_arena; }
+
+	/* Bounds-checked read of a single `T` at `offset`.
+	 * Table decoders should check the whole table once with `ELF_data_at` and use
+	 * `ELF_read_value` on the returned pointer instead.
+	 * */
+	template<typename T, std::endian order>
 		requires std::is_integral<T>::value
-			&& (!std::is_class<T>::value)
-	void check_data(T data, T data_to_expect)
+	ElfResult<T> ELF_read(size_t offset)
 	{
-		ELF_ASSERT(data == data_to_expect,
-			"\nThe data retained (%X) did not match what was expected (%X)\n",
-			data, data_to_expect)
+		ElfResult<const uint8_t *> data = ELF_data_at(offset, sizeof(T));
+
+		if(!data)
+			return data.error();
+
+		return ELF_read_value<T, order>(*data);
 	}
 
-	ElfDecoder(FILE *f)
-		: bin(f), seek_pos(0), backup_seek_pos(0)
+	/* There is no file to decode until the first `ELF_reset`. */
+	ElfDecoder()
+		: bin(-1), ELF_binary_size(0), ELF_mapped(false), ELF_loaded_ranges(ELF_arena), ELF_load_mode(ELF_load_modes::Mapped)
+	{}
+
+	/* Decode `fd` from now on, as if the decoder had just been made for it.
+	 * The previous file's mapping and everything allocated from the arena go away, but the
+	 * fallback buffer and the arena's memory are kept for the next file.
+	 * A negative `fd` (a failed `open`) leaves the decoder without a file and fails with `Open_Failed`.
+	 * */
+	ElfStatus ELF_reset(int fd, ELF_load_modes mode = ELF_load_modes::Mapped)
 	{
-		ELF_ASSERT(bin,
-			"\nThe ELF binary file does not exist.\n")
-		
-		fseek(bin, 0, SEEK_END);
-		size_t size = ftell(bin);
-		fseek(bin, 0, SEEK_SET);
+		ELF_release_binary();
+
+		bin = fd;
+		ELF_load_mode = mode;
+		ELF_fallback_buffer.clear();
+		ELF_loaded_ranges.reset();
+		ELF_adopted_ranges.clear();
+		ELF_arena.release();
+
+		if(bin < 0)
+			return ELF_errors::Open_Failed;
 
-		ELF_binary = new uint8_t[size];
-		fread(ELF_binary, size, sizeof(*ELF_binary), bin);
+		if(ELF_load_mode == ELF_load_modes::Lazy)
+			ELF_open_lazily();
+		else
+			ELF_map_binary();
+
+		return ElfStatus();
 	}
 
 	template<typename T>
@@ -211,8 +661,8 @@ public:
 
 	~ElfDecoder()
 	{
-		if(ELF_binary) delete ELF_binary;
-		ELF_binary = nullptr;
+		/* The fallback buffer cleans up after itself. */
+		ELF_release_binary();
 	}
 };
 
@@ -0,0 +1,156 @@
+#ifndef ELF_ASYNC_H
+#define ELF_ASYNC_H
+#include "common.hpp"
+#include "elf_sections.hpp"
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+using namespace elf_sections;
+
+/* How many reads the io_uring backend keeps in flight. */
+#define ELF_ASYNC_QUEUE_DEPTH			256
+/* How many threads the `pread` fallback keeps blocked in reads. */
+#define ELF_ASYNC_FALLBACK_THREADS		32
+/* How many files may be read in (or be in flight) but not released yet, per read in flight. */
+#define ELF_ASYNC_FILES_PER_READ		2
+
+namespace elf_async
+{
+	enum class ElfAsyncBackends: uint8_t
+	{
+		IoUring		= 0x0,
+		ThreadPool	= 0x1
+	};
+
+	static inline uint8_t *get_async_backend_name(ElfAsyncBackends backend)
+	{
+		switch(backend)
+		{
+			case ElfAsyncBackends::IoUring: return (uint8_t *) "io_uring";break;
+			case ElfAsyncBackends::ThreadPool: return (uint8_t *) "pread thread pool";break;
+			default: break;
+		}
+
+		return (uint8_t *) "Unknown";
+	}
+
+	/* Everything read in for one file, ready to be handed to `ElfDecoder::ELF_adopt_ranges`.
+	 * `fd` is left open for the decoder (it still reads anything that was not read in here);
+	 * `fd` is -1 if the file could not be opened.
+	 * */
+	struct ElfPrefetchedFile
+	{
+		int										fd;
+		size_t									size;
+		std::vector<struct ElfDecoder::ELF_range>	ranges;
+	};
+
+	/* Reads the parts of many files that the decoders need up front, with many reads in flight at once.
+	 *
+	 * Each file is read in three rounds, each depending on the one before it:
+	 *   1. the ELF header,
+	 *   2. the program header table and the section header table,
+	 *   3. the section name string table.
+	 * With io_uring, the reads for all files are submitted to one ring and a file moves on to its
+	 * next round as soon as its reads complete, so up to `ELF_ASYNC_QUEUE_DEPTH` reads (across
+	 * files) are queued on the device at any time. Without io_uring (old kernels, or when it is
+	 * disabled), `ELF_ASYNC_FALLBACK_THREADS` threads do the same rounds with blocking `pread`s;
+	 * they also take over the files that are left if the ring fails partway through.
+	 *
+	 * Files are read in the order they were given, and only a bounded number of them are kept
+	 * around until they are `release`d, so a slow consumer holds back the reads.
+	 * */
+	class ElfAsyncReader
+	{
+	protected:
+		/* A raw io_uring (there is no liburing dependency); only set up if the kernel supports it. */
+		struct uring
+		{
+			int							fd;
+			uint32_t					*sq_head;
+			uint32_t					*sq_tail;
+			uint32_t					*sq_mask;
+			uint32_t					*sq_array;
+			struct io_uring_sqe			*sqes;
+			uint32_t					*cq_head;
+			uint32_t					*cq_tail;
+			uint32_t					*cq_mask;
+			struct io_uring_cqe			*cqes;
+			void						*sq_ring;
+			void						*cq_ring;
+			size_t						sq_ring_size;
+			size_t						cq_ring_size;
+			size_t						sqes_size;
+			uint32_t					entries;
+		};
+
+		/* Where each file is at. */
+		struct file_state
+		{
+			struct ElfPrefetchedFile	prefetched;
+			uint8_t						round;
+			uint8_t						reads_pending;
+			struct iovec				vectors[2];
+			bool						ready;
+		};
+
+		ElfAsyncBackends backend;
+		struct uring ring;
+		uint32_t queue_depth;
+		uint32_t file_limit;
+
+		const std::vector<const char *> *files;
+		std::vector<struct file_state> states;
+		std::thread reader;
+
+		/* Guards `ready` in `states`, `released` and `stopping`. */
+		std::mutex lock;
+		std::condition_variable file_ready;
+		std::condition_variable file_released;
+		uint32_t released;
+		bool stopping;
+
+		/* For the `pread` fallback. */
+		std::atomic<uint32_t> next_file;
+		std::vector<std::thread> fallback_threads;
+
+		bool setup_ring();
+		void destroy_ring();
+
+		void open_file(uint32_t index);
+		uint32_t plan_reads(uint32_t index);
+		void finish_file(uint32_t index);
+		bool wait_for_room(uint32_t index);
+
+		void run_ring();
+		void abandon_ring(uint32_t submitted, uint32_t next);
+		void run_fallback();
+
+	public:
+		/* Set up io_uring if the kernel supports it (and `use_io_uring`), the `pread` fallback otherwise. */
+		ElfAsyncReader(bool use_io_uring = true, uint32_t depth = ELF_ASYNC_QUEUE_DEPTH);
+
+		/* Start reading `files` in the background.
+		 * At least `lookahead` files get read ahead of the oldest one that has not been released,
+		 * which has to cover however far ahead the consumer may ask for files (see `ElfBatch::get_window`).
+		 * */
+		void start(const std::vector<const char *> &files, uint32_t lookahead = 0);
+
+		/* Wait until file `index` has been read in. */
+		struct ElfPrefetchedFile &wait_for(uint32_t index);
+
+		/* Let the reader move on. The caller takes over the file's buffers (`ELF_adopt_ranges`) and its
+		 * descriptor (setting `fd` to -1) before this; whatever it did not take is freed and closed here.
+		 * */
+		void release(uint32_t index);
+
+		ElfAsyncBackends get_backend() { return backend; }
+
+		~ElfAsyncReader();
+	};
+}
+
+#endif
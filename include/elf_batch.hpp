@@ -0,0 +1,81 @@
+#ifndef ELF_BATCH_H
+#define ELF_BATCH_H
+#include "common.hpp"
+#include "elf_output.hpp"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+/* How many finished-but-not-yet-printed files each worker may be ahead by. */
+#define ELF_BATCH_WINDOW_PER_WORKER		4
+
+using namespace elf_output;
+
+namespace elf_batch
+{
+	/* Decodes many files at once on a pool of worker threads.
+	 *
+	 * Files are dealt out round-robin to per-worker queues; a worker that runs out of files
+	 * steals the lowest-numbered file from another worker's queue. Each file's output is
+	 * formatted into the worker's `ElfOutput` and handed back through a bounded reorder buffer,
+	 * so the output comes out in the same order as the files were given, and workers can only
+	 * get `window` files ahead of the oldest file that has not been printed yet.
+	 *
+	 * Handing a file's output over swaps buffers with the slot instead of copying, so the
+	 * buffers just go around between the workers and the printing thread and, once they have
+	 * grown big enough, nothing gets allocated per file.
+	 * */
+	class ElfBatch
+	{
+	public:
+		/* Decode `filename` (the `index`th file), writing everything that would be printed to `out`. */
+		using decode_function = std::function<void (uint32_t index, const char *filename, ElfOutput &out)>;
+
+	protected:
+		struct worker_queue
+		{
+			std::mutex				lock;
+			std::deque<uint32_t>	files;
+		};
+
+		/* One slot of the reorder buffer; file `i` goes into slot `i % window`. */
+		struct output_slot
+		{
+			std::vector<char>	data;
+			size_t				size;
+			bool				ready;
+		};
+
+		uint32_t worker_amnt;
+		bool colors;
+		uint32_t window;
+		std::vector<struct worker_queue> queues;
+		std::vector<struct output_slot> slots;
+
+		/* Guards `slots` and `next_to_print`. */
+		std::mutex output_lock;
+		std::condition_variable slot_ready;
+		std::condition_variable window_moved;
+		uint32_t next_to_print;
+
+		bool take_file(uint32_t worker, uint32_t &file);
+		void run_worker(uint32_t worker, const std::vector<const char *> &files, decode_function &decode);
+
+	public:
+		/* `workers` of 0 means one worker per core. */
+		ElfBatch(uint32_t workers = 0, bool with_colors = true);
+
+		/* Decode all of `files` and write their output, in order, to `out`. */
+		void run(const std::vector<const char *> &files, decode_function decode, int out = STDOUT_FILENO);
+
+		uint32_t get_worker_amnt() { return worker_amnt; }
+		/* How far past the oldest unprinted file a worker may start decoding. */
+		uint32_t get_window() { return window; }
+
+		~ElfBatch() = default;
+	};
+}
+
+#endif
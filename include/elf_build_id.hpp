@@ -0,0 +1,73 @@
+#ifndef ELF_BUILD_ID_H
+#define ELF_BUILD_ID_H
+#include "common.hpp"
+#include "elf_cache.hpp"
+#include <mutex>
+#include <string>
+using namespace elf_cache;
+
+/* First bytes of a build ID index; a different version means the entries are laid out differently. */
+#define ELF_BUILD_ID_INDEX_MAGIC		"ELFBIDX"
+#define ELF_BUILD_ID_INDEX_VERSION		1
+
+namespace elf_build_id
+{
+	/* Maps build IDs to the files that have them, the way a symbol server would: given the build
+	 * ID in a core dump or a stack trace, find the binary it came from.
+	 *
+	 * The index file is a 16 byte header, fixed size entries sorted by build ID, then the paths
+	 * the entries point into. Looking a build ID up maps the file in and binary searches the
+	 * entries; nothing is read besides the pages that search touches.
+	 * */
+	class ElfBuildIdIndex
+	{
+	protected:
+		struct index_header
+		{
+			char		magic[8];
+			uint32_t	version;
+			uint32_t	entry_amnt;
+		};
+
+		struct index_entry
+		{
+			uint8_t		build_id[ELF_BUILD_ID_MAX_SIZE];	/* zero padded, so entries compare with one `memcmp` */
+			uint32_t	build_id_size;
+			uint32_t	path_size;
+			uint64_t	path_offset;						/* from the end of the entries */
+		};
+		static_assert(sizeof(struct index_entry) % 8 == 0);
+
+		static bool entry_less(const struct index_entry &a, const struct index_entry &b)
+		{
+			int order = memcmp(a.build_id, b.build_id, sizeof(a.build_id));
+			return order != 0 ? order < 0 : a.build_id_size < b.build_id_size;
+		}
+
+		/* Guards `entries` and `paths`. */
+		std::mutex entries_lock;
+		std::vector<struct index_entry> entries;
+		std::string paths;
+
+	public:
+		ElfBuildIdIndex() = default;
+
+		/* Keep `path` under `build_id` for the next `write`. Safe to call from any thread. */
+		void add(const uint8_t *build_id, uint32_t build_id_size, std::string_view path);
+
+		/* Write the index to `path`, replacing whatever was there; false if it could not be written. */
+		bool write(const char *path);
+
+		/* Look `build_id` up in the index file at `index_path`; false if it is not in there. */
+		static bool lookup(const char *index_path, const uint8_t *build_id, uint32_t build_id_size, std::string &path);
+
+		/* Bytes of the build ID spelled out in hex by `hex`, or 0 if that is not a build ID. */
+		static uint32_t parse_build_id(const char *hex, uint8_t build_id[ELF_BUILD_ID_MAX_SIZE]);
+
+		uint32_t get_entry_amnt() { return entries.size(); }
+
+		~ElfBuildIdIndex() = default;
+	};
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef ELF_CACHE_H
+#define ELF_CACHE_H
+#include "common.hpp"
+#include "elf_notes.hpp"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+using namespace elf_notes;
+
+/* First bytes of a cache file; a different version means the records are laid out differently. */
+#define ELF_CACHE_MAGIC				"ELFCACHE"
+#define ELF_CACHE_VERSION			1
+/* Start of every record, so a record cut short by a crash is noticed instead of read. */
+#define ELF_CACHE_RECORD_MAGIC		0x454C4652
+
+/* What `contains` gives for a file that is not in the cache. */
+#define ELF_CACHE_NO_RECORD			UINT64_MAX
+
+/* Longest build ID that gets kept; SHA-1 (20 bytes) is what linkers use by default. */
+#define ELF_BUILD_ID_MAX_SIZE		0x20
+
+namespace elf_cache
+{
+	/* What uniquely identifies a file's contents without reading it. */
+	struct ElfCacheKey
+	{
+		uint64_t	device;
+		uint64_t	inode;
+		uint64_t	size;
+		uint64_t	mtime_ns;
+
+		bool operator==(const struct ElfCacheKey &other) const = default;
+	};
+
+	struct ElfCacheKeyHash
+	{
+		size_t operator()(const struct ElfCacheKey &key) const
+		{
+			/* The inode alone is nearly unique; the rest just gets mixed in. */
+			uint64_t hash = key.inode * 0x9E3779B97F4A7C15 ^ key.device;
+			hash = (hash ^ key.size) * 0x9E3779B97F4A7C15;
+			return hash ^ key.mtime_ns ^ (hash >> 29);
+		}
+	};
+
+	/* Everything the summary report shows about a file. It is stored in the cache as-is (in the
+	 * host's byte order), followed by `pheader_amnt` program headers.
+	 * */
+	struct ElfFileSummary
+	{
+		uint32_t						record_magic;		/* `ELF_CACHE_RECORD_MAGIC` */
+		uint32_t						record_size;		/* this and the program headers after it, rounded up to 8 bytes */
+		struct ElfCacheKey				key;
+		struct ElfHeader::ELF_header	header;
+		uint32_t						pheader_amnt;
+		uint32_t						section_amnt;
+		uint32_t						allocated_amnt;		/* sections occupying memory */
+		uint32_t						build_id_size;
+		uint64_t						allocated_size;		/* bytes of them in the file */
+		uint64_t						bss_size;
+		bool							has_symbols;		/* has `.symtab` (not stripped) */
+		bool							has_debug_info;		/* has `.debug_info` */
+		uint8_t							build_id[ELF_BUILD_ID_MAX_SIZE];
+	};
+	static_assert(sizeof(struct ElfFileSummary) % 8 == 0 && std::is_trivially_copyable<struct ElfFileSummary>::value);
+
+	/* A file's summary along with its program headers, which live either in the cache file or in
+	 * the decoder the summary was made with.
+	 * */
+	struct ElfSummaryView
+	{
+		struct ElfFileSummary						summary;
+		const struct ElfProgramHeader::ProgramHeader	*pheaders;
+	};
+
+	/* A cache of file summaries, kept on disk between runs.
+	 *
+	 * The cache file is a 16 byte header followed by records, one per file, that are only ever
+	 * appended. It is mapped in when the cache is opened and indexed by (device, inode, size,
+	 * mtime in ns); a later record for the same file (device and inode) makes the earlier one
+	 * stale. A file whose key is in there is never opened: looking it up costs one `stat`.
+	 * Summaries of files that were not in there are gathered in memory (from any thread) and
+	 * appended with one write by `save`. Once more than half of the records are stale, `save`
+	 * rewrites the file with only the live ones.
+	 * */
+	class ElfDecodeCache
+	{
+	protected:
+		struct cache_header
+		{
+			char		magic[8];
+			uint32_t	version;
+			uint32_t	summary_size;		/* `sizeof(struct ElfFileSummary)` */
+		};
+
+		std::string cache_path;
+		int cache_fd;
+		const uint8_t *cache_data;
+		size_t cache_size;
+		size_t valid_size;				/* up to the first record that is cut short or corrupt */
+		uint32_t stale_amnt;
+
+		/* Offsets of the latest record for each key; never changes once the cache is open. */
+		std::unordered_map<struct ElfCacheKey, size_t, ElfCacheKeyHash> records;
+
+		/* Guards `pending`. */
+		std::mutex pending_lock;
+		std::vector<uint8_t> pending;
+
+		void load_records();
+		bool write_records(int fd, size_t offset, bool with_live_records);
+		bool lock_current_file(bool &replaced);
+
+	public:
+		/* Opens (or creates) the cache file at `path`. */
+		ElfDecodeCache(const char *path);
+
+		static struct ElfCacheKey make_key(const struct stat &file_stats)
+		{
+			return { (uint64_t) file_stats.st_dev, (uint64_t) file_stats.st_ino, (uint64_t) file_stats.st_size,
+				(uint64_t) file_stats.st_mtim.tv_sec * 1000000000 + (uint64_t) file_stats.st_mtim.tv_nsec };
+		}
+
+		/* Summary of the file at `path` (relative to `directory_fd`), if the cache has one for the file as it is now.
+		 * Like opening it would, this follows symbolic links.
+		 * */
+		bool lookup(int directory_fd, const char *path, struct ElfSummaryView &view);
+		/* Whether the cache has the file as it is now, without following symbolic links (like the
+		 * directory scan); `record` is where its summary is, for `get_summary`. Only ELF binary files are ever cached.
+		 * */
+		bool contains(int directory_fd, const char *name, uint64_t &record);
+		/* The summary at `record`, as found by `contains`; the file is not looked at again. */
+		void get_summary(uint64_t record, struct ElfSummaryView &view);
+
+		/* Gather the summary of a decoded file, whose notes are `notes`. `key` is from the open file's `fstat`. */
+		static ElfStatus summarize(ElfSection &elf_sections, ElfNotes &notes, const struct ElfCacheKey &key, struct ElfSummaryView &view);
+
+		/* Keep `view` for the next `save`. Safe to call from any thread. */
+		void insert(const struct ElfSummaryView &view);
+
+		/* Append every summary inserted since the cache was opened.
+		 * Returns false (after saying why) if they could not be written; they are kept for another try.
+		 * */
+		bool save();
+
+		static void print_summary(const struct ElfSummaryView &view, const char *filename, ElfOutput &out);
+		/* The fields of the summary, for the JSON output formats. */
+		static void print_summary_json(const struct ElfSummaryView &view, ElfOutput &out);
+
+		uint32_t get_record_amnt() { return records.size(); }
+
+		~ElfDecodeCache();
+	};
+}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef ELF_CLASS_H
+#define ELF_CLASS_H
+#include "common.hpp"
+
+/* Values of the ELF type/endianess bytes (bytes 5 and 6) of the ELF header. */
+#define ELF_CLASS_32			0x01
+#define ELF_CLASS_64			0x02
+#define ELF_DATA_LITTLE			0x01
+#define ELF_DATA_BIG			0x02
+
+/* Length of the identification bytes at the start of every ELF binary file. */
+#define ELF_IDENT_SIZE			0x10
+
+namespace elf_class
+{
+	/* On-disk layouts, exactly as they appear in the file (in the file's byte order). */
+	struct ELF32_raw_header
+	{
+		uint8_t		e_ident[ELF_IDENT_SIZE];
+		uint16_t	e_type;
+		uint16_t	e_machine;
+		uint32_t	e_version;
+		uint32_t	e_entry;
+		uint32_t	e_phoff;
+		uint32_t	e_shoff;
+		uint32_t	e_flags;
+		uint16_t	e_ehsize;
+		uint16_t	e_phentsize;
+		uint16_t	e_phnum;
+		uint16_t	e_shentsize;
+		uint16_t	e_shnum;
+		uint16_t	e_shstrndx;
+	};
+
+	struct ELF64_raw_header
+	{
+		uint8_t		e_ident[ELF_IDENT_SIZE];
+		uint16_t	e_type;
+		uint16_t	e_machine;
+		uint32_t	e_version;
+		uint64_t	e_entry;
+		uint64_t	e_phoff;
+		uint64_t	e_shoff;
+		uint32_t	e_flags;
+		uint16_t	e_ehsize;
+		uint16_t	e_phentsize;
+		uint16_t	e_phnum;
+		uint16_t	e_shentsize;
+		uint16_t	e_shnum;
+		uint16_t	e_shstrndx;
+	};
+
+	struct ELF32_raw_program_header
+	{
+		uint32_t	p_type;
+		uint32_t	p_offset;
+		uint32_t	p_vaddr;
+		uint32_t	p_paddr;
+		uint32_t	p_filesz;
+		uint32_t	p_memsz;
+		uint32_t	p_flags;
+		uint32_t	p_align;
+	};
+
+	/* `p_flags` moves up to keep the 64-bit fields aligned. */
+	struct ELF64_raw_program_header
+	{
+		uint32_t	p_type;
+		uint32_t	p_flags;
+		uint64_t	p_offset;
+		uint64_t	p_vaddr;
+		uint64_t	p_paddr;
+		uint64_t	p_filesz;
+		uint64_t	p_memsz;
+		uint64_t	p_align;
+	};
+
+	struct ELF32_raw_section_header
+	{
+		uint32_t	sh_name;
+		uint32_t	sh_type;
+		uint32_t	sh_flags;
+		uint32_t	sh_addr;
+		uint32_t	sh_offset;
+		uint32_t	sh_size;
+		uint32_t	sh_link;
+		uint32_t	sh_info;
+		uint32_t	sh_addralign;
+		uint32_t	sh_entsize;
+	};
+
+	struct ELF64_raw_section_header
+	{
+		uint32_t	sh_name;
+		uint32_t	sh_type;
+		uint64_t	sh_flags;
+		uint64_t	sh_addr;
+		uint64_t	sh_offset;
+		uint64_t	sh_size;
+		uint32_t	sh_link;
+		uint32_t	sh_info;
+		uint64_t	sh_addralign;
+		uint64_t	sh_entsize;
+	};
+
+	struct ELF32_raw_symbol
+	{
+		uint32_t	st_name;
+		uint32_t	st_value;
+		uint32_t	st_size;
+		uint8_t		st_info;
+		uint8_t		st_other;
+		uint16_t	st_shndx;
+	};
+
+	/* The small fields move up to keep the 64-bit fields aligned. */
+	struct ELF64_raw_symbol
+	{
+		uint32_t	st_name;
+		uint8_t		st_info;
+		uint8_t		st_other;
+		uint16_t	st_shndx;
+		uint64_t	st_value;
+		uint64_t	st_size;
+	};
+
+	struct ELF32_raw_rel
+	{
+		uint32_t	r_offset;
+		uint32_t	r_info;			/* symbol index << 8 | type */
+	};
+
+	struct ELF32_raw_rela
+	{
+		uint32_t	r_offset;
+		uint32_t	r_info;
+		int32_t		r_addend;
+	};
+
+	struct ELF64_raw_rel
+	{
+		uint64_t	r_offset;
+		uint64_t	r_info;			/* symbol index << 32 | type */
+	};
+
+	struct ELF64_raw_rela
+	{
+		uint64_t	r_offset;
+		uint64_t	r_info;
+		int64_t		r_addend;
+	};
+
+	struct ELF32_raw_dynamic
+	{
+		int32_t		d_tag;
+		uint32_t	d_val;			/* a value or an address, depending on the tag */
+	};
+
+	struct ELF64_raw_dynamic
+	{
+		int64_t		d_tag;
+		uint64_t	d_val;
+	};
+
+	static_assert(sizeof(struct ELF32_raw_header) == 0x34 && sizeof(struct ELF64_raw_header) == 0x40);
+	static_assert(sizeof(struct ELF32_raw_program_header) == 0x20 && sizeof(struct ELF64_raw_program_header) == 0x38);
+	static_assert(sizeof(struct ELF32_raw_section_header) == 0x28 && sizeof(struct ELF64_raw_section_header) == 0x40);
+	static_assert(sizeof(struct ELF32_raw_symbol) == 0x10 && sizeof(struct ELF64_raw_symbol) == 0x18);
+	static_assert(sizeof(struct ELF32_raw_rel) == 0x8 && sizeof(struct ELF64_raw_rel) == 0x10);
+	static_assert(sizeof(struct ELF32_raw_rela) == 0xC && sizeof(struct ELF64_raw_rela) == 0x18);
+	static_assert(sizeof(struct ELF32_raw_dynamic) == 0x8 && sizeof(struct ELF64_raw_dynamic) == 0x10);
+
+	/* Everything that differs between 32-bit and 64-bit ELF binary files. */
+	struct Elf32
+	{
+		using Header			= struct ELF32_raw_header;
+		using ProgramHeader		= struct ELF32_raw_program_header;
+		using SectionHeader		= struct ELF32_raw_section_header;
+		using Symbol			= struct ELF32_raw_symbol;
+		using Rel				= struct ELF32_raw_rel;
+		using Rela				= struct ELF32_raw_rela;
+		using Dynamic			= struct ELF32_raw_dynamic;
+		using Word				= uint32_t;	/* Addresses, offsets and sizes. */
+
+		static constexpr uint8_t elf_class = ELF_CLASS_32;
+
+		static constexpr uint32_t relocation_type(Word info) { return info & 0xFF; }
+		static constexpr uint32_t relocation_symbol(Word info) { return info >> 8; }
+	};
+
+	struct Elf64
+	{
+		using Header			= struct ELF64_raw_header;
+		using ProgramHeader		= struct ELF64_raw_program_header;
+		using SectionHeader		= struct ELF64_raw_section_header;
+		using Symbol			= struct ELF64_raw_symbol;
+		using Rel				= struct ELF64_raw_rel;
+		using Rela				= struct ELF64_raw_rela;
+		using Dynamic			= struct ELF64_raw_dynamic;
+		using Word				= uint64_t;
+
+		static constexpr uint8_t elf_class = ELF_CLASS_64;
+
+		static constexpr uint32_t relocation_type(Word info) { return info & 0xFFFFFFFF; }
+		static constexpr uint32_t relocation_symbol(Word info) { return info >> 32; }
+	};
+
+	/* A class (32/64-bit) paired with a byte order.
+	 * Decoders are templated on this, so each of the four combinations gets its own
+	 * instantiation with no per-field checks of the class or the byte order.
+	 * */
+	template<typename Class, std::endian Order>
+	struct ElfTraits : public Class
+	{
+		static constexpr std::endian order = Order;
+
+		static constexpr size_t header_size = sizeof(typename Class::Header);
+		static constexpr size_t program_header_size = sizeof(typename Class::ProgramHeader);
+		static constexpr size_t section_header_size = sizeof(typename Class::SectionHeader);
+		static constexpr size_t symbol_size = sizeof(typename Class::Symbol);
+		static constexpr size_t dynamic_size = sizeof(typename Class::Dynamic);
+
+		/* Fix up the byte order of a field that was copied out of the file. */
+		template<typename T>
+			requires std::is_integral<T>::value
+		static constexpr T get(T value)
+		{
+			if constexpr(Order != std::endian::native && sizeof(T) > 1)
+				return ELF_byte_swap(value);
+
+			return value;
+		}
+
+		/* Copy one of the raw structures above out of the file. `source` must be in bounds. */
+		template<typename T>
+		static T overlay(const uint8_t *source)
+		{
+			T raw;
+			memcpy(&raw, source, sizeof(T));
+			return raw;
+		}
+	};
+
+	using Elf32LE = ElfTraits<Elf32, std::endian::little>;
+	using Elf32BE = ElfTraits<Elf32, std::endian::big>;
+	using Elf64LE = ElfTraits<Elf64, std::endian::little>;
+	using Elf64BE = ElfTraits<Elf64, std::endian::big>;
+
+	/* Pick the traits for the file once, based on its ELF type/endianess bytes, and
+	 * call `decode.template operator()<Traits>()`.
+	 * The bytes must already have been validated.
+	 * */
+	template<typename F>
+	auto ELF_dispatch(uint8_t elf_type, uint8_t elf_endianess, F &&decode)
+	{
+		if(elf_type == ELF_CLASS_64)
+		{
+			if(elf_endianess == ELF_DATA_BIG)
+				return decode.template operator()<Elf64BE>();
+			return decode.template operator()<Elf64LE>();
+		}
+
+		if(elf_endianess == ELF_DATA_BIG)
+			return decode.template operator()<Elf32BE>();
+		return decode.template operator()<Elf32LE>();
+	}
+}
+
+#endif
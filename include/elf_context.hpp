@@ -0,0 +1,68 @@
+#ifndef ELF_CONTEXT_H
+#define ELF_CONTEXT_H
+#include "common.hpp"
+#include "elf_symbols.hpp"
+#include "elf_dynamic.hpp"
+#include "elf_notes.hpp"
+#include "elf_relocations.hpp"
+using namespace elf_symbols;
+using namespace elf_dynamic;
+using namespace elf_notes;
+using namespace elf_relocations;
+
+namespace elf_context
+{
+	/* Everything one thread needs to decode a file, kept from one file to the next.
+	 *
+	 * Decoding a file used to make the whole chain of decoders (the header, its `ElfDecoder`,
+	 * the tables...) and free all of it again once the file was done. A context is made once
+	 * per thread instead, and `reset` points it at the next file. The decoders are kept, and so
+	 * is the memory of the decoder's arena, which the header, the lazily read ranges and every
+	 * decoded table come out of; once it has grown big enough for the files going through,
+	 * decoding a file does not allocate anything.
+	 *
+	 * Whatever `reset` and the getters hand out is only good until the next `reset`.
+	 * */
+	class ElfDecodeContext
+	{
+	protected:
+		/* Made by the first `reset`, the rest the first time they are asked for. */
+		ElfSection *elf_sections;
+		ElfSymbolTable *symbol_table;
+		ElfSymbolTable *dynamic_symbol_table;
+		ElfDynamic *dynamic;
+		ElfNotes *notes;
+		ElfRelocations *relocations;
+
+	public:
+		ElfDecodeContext()
+			: elf_sections(nullptr), symbol_table(nullptr), dynamic_symbol_table(nullptr), dynamic(nullptr), notes(nullptr), relocations(nullptr)
+		{}
+
+		/* Decode `fd` from now on; `filename` must outlive the next `reset`. Nothing is decoded yet,
+		 * so this only fails (with `Open_Failed`) if `fd` is not an open file.
+		 * */
+		ElfStatus reset(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped);
+
+		ElfSection &get_sections() { return *elf_sections; }
+
+		/* Made the first time they are asked for; what they decode is kept until the next `reset`. */
+		ElfSymbolTable &get_symbol_table(SectionTypes type = SectionTypes::SHT_SYMTAB);
+		ElfDynamic &get_dynamic();
+		ElfNotes &get_notes();
+		ElfRelocations &get_relocations();
+
+		template<typename T>
+			requires std::is_same<T, ElfDecodeContext *>::value
+		void delete_instance(T instance)
+		{
+			if(instance)
+				delete instance;
+			instance = nullptr;
+		}
+
+		~ElfDecodeContext();
+	};
+}
+
+#endif
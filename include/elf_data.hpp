@@ -11,8 +11,8 @@ namespace elf_binary_data
 	{
 	public:
 		ElfBinary() = default;
-		ElfBinary(FILE *f, int8_t &filename)
-			: ElfSegment(f, filename)
+		ElfBinary(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
+			: ElfSegment(fd, filename, mode)
 		{}
 
 		template<typename T>
@@ -0,0 +1,97 @@
+#ifndef ELF_DEPENDENCIES_H
+#define ELF_DEPENDENCIES_H
+#include "common.hpp"
+#include "elf_context.hpp"
+#include <string>
+#include <unordered_map>
+using namespace elf_context;
+
+/* What a `DT_NEEDED` entry resolves to when no library could be found for it. */
+#define ELF_LIBRARY_NOT_FOUND		UINT32_MAX
+
+/* Where the search ends up when nothing else has the library. */
+#define ELF_LIBRARY_CONFIG			"/etc/ld.so.conf"
+
+namespace elf_dependencies
+{
+	/* Resolves the shared libraries that binaries depend on, the way the dynamic linker would
+	 * (without running anything): `DT_RPATH`, `LD_LIBRARY_PATH`, `DT_RUNPATH`, the directories
+	 * in `/etc/ld.so.conf`, then the default ones. Libraries for another class or machine are
+	 * skipped over, as the dynamic linker does.
+	 *
+	 * Every file is decoded at most once: libraries are kept by their real path, so a library
+	 * that a thousand binaries depend on is only opened the first time. Names that resolve
+	 * without the help of a binary's own search paths are cached as well, so looking them up
+	 * again does not even touch the file system.
+	 * */
+	class ElfDependencyGraph
+	{
+	public:
+		struct Library
+		{
+			std::string					path;			/* where it was first found */
+			std::string					soname;
+			std::string					rpath;
+			std::string					runpath;
+			std::vector<std::string>	needed;
+			std::vector<uint32_t>		dependencies;	/* one per `needed`, or `ELF_LIBRARY_NOT_FOUND` */
+			uint8_t						elf_class;
+			uint16_t					machine;
+			bool						is_elf;			/* false for anything that could not be decoded */
+			ElfStatus					status;			/* why, if it could not be */
+			bool						is_dynamic;		/* has `PT_DYNAMIC` */
+			bool						resolved;		/* `dependencies` has been filled in */
+		};
+
+	protected:
+		std::vector<struct Library> libraries;
+		std::unordered_map<std::string, uint32_t> library_index;		/* by real path */
+		std::unordered_map<std::string, uint32_t> resolved_names;		/* by name, class and machine */
+
+		std::vector<std::string> library_path;			/* `LD_LIBRARY_PATH` */
+		std::vector<std::string> system_directories;	/* `/etc/ld.so.conf`, then the defaults */
+
+		/* Every library is decoded with this one, so decoding the next does not allocate a new chain of decoders. */
+		ElfDecodeContext context;
+
+		void read_library_config(const char *config, uint32_t depth);
+		void decode_library(struct Library &library, const char *real_path);
+
+		/* Look `name` up in the `:`/`;` separated `search_path`, expanding `$ORIGIN` to `origin`. */
+		uint32_t search_path(std::string_view name, std::string_view search_path, std::string_view origin, const struct Library &from);
+		uint32_t search_directories(std::string_view name, const std::vector<std::string> &directories, const struct Library &from);
+		/* The library at `path`, if it is one `from` could load. */
+		uint32_t try_library(const std::string &path, const struct Library &from);
+
+		uint32_t find_library(std::string_view name, uint32_t from);
+
+	public:
+		ElfDependencyGraph();
+
+		/* Node of the file at `path`, decoding it if it has not been seen yet; `ELF_LIBRARY_NOT_FOUND` if there is no such file. */
+		uint32_t add_file(const char *path);
+		/* Whether the file of `node` could be decoded; libraries that could not be are passed over while resolving. */
+		ElfStatus get_status(uint32_t node) { return node == ELF_LIBRARY_NOT_FOUND ? ElfStatus(ELF_errors::Open_Failed) : libraries[node].status; }
+
+		/* Resolve the dependencies of `node`, and of everything it depends on. */
+		void resolve(uint32_t node);
+
+		/* Every library `node` depends on (directly or not), once each and in the order they would be
+		 * loaded in, paired with the name it was needed by; libraries that could not be found are
+		 * `ELF_LIBRARY_NOT_FOUND`.
+		 * */
+		void get_load_order(uint32_t node, std::vector<std::pair<std::string_view, uint32_t>> &load_order);
+
+		uint32_t get_library_amnt() { return libraries.size(); }
+		const struct Library &get_library(uint32_t node) { return libraries[node]; }
+
+		/* Like `ldd`: every needed library and where it was found. */
+		void print_dependencies(uint32_t node, const char *filename, ElfOutput &out);
+		/* `"needed":[...],"dependencies":[...]`, for the JSON output formats. */
+		void print_dependencies_json(uint32_t node, ElfOutput &out);
+
+		~ElfDependencyGraph() = default;
+	};
+}
+
+#endif
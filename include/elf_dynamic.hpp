@@ -0,0 +1,206 @@
+#ifndef ELF_DYNAMIC_H
+#define ELF_DYNAMIC_H
+#include "common.hpp"
+#include "elf_sections.hpp"
+using namespace elf_sections;
+
+namespace elf_dynamic
+{
+	enum class DynamicTags: uint64_t
+	{
+		DT_NULL				= 0x0,		/* end of the dynamic section */
+		DT_NEEDED			= 0x1,		/* name of a needed library */
+		DT_PLTRELSZ			= 0x2,
+		DT_PLTGOT			= 0x3,
+		DT_HASH				= 0x4,
+		DT_STRTAB			= 0x5,		/* address of the dynamic string table */
+		DT_SYMTAB			= 0x6,
+		DT_RELA				= 0x7,
+		DT_RELASZ			= 0x8,
+		DT_RELAENT			= 0x9,
+		DT_STRSZ			= 0xA,		/* size of the dynamic string table */
+		DT_SYMENT			= 0xB,
+		DT_INIT				= 0xC,
+		DT_FINI				= 0xD,
+		DT_SONAME			= 0xE,		/* name of this shared object */
+		DT_RPATH			= 0xF,		/* library search path, searched before `LD_LIBRARY_PATH` */
+		DT_SYMBOLIC			= 0x10,
+		DT_REL				= 0x11,
+		DT_RELSZ			= 0x12,
+		DT_RELENT			= 0x13,
+		DT_PLTREL			= 0x14,
+		DT_DEBUG			= 0x15,
+		DT_TEXTREL			= 0x16,
+		DT_JMPREL			= 0x17,
+		DT_BIND_NOW			= 0x18,
+		DT_INIT_ARRAY		= 0x19,
+		DT_FINI_ARRAY		= 0x1A,
+		DT_INIT_ARRAYSZ		= 0x1B,
+		DT_FINI_ARRAYSZ		= 0x1C,
+		DT_RUNPATH			= 0x1D,		/* library search path, searched after `LD_LIBRARY_PATH` */
+		DT_FLAGS			= 0x1E,
+		DT_PREINIT_ARRAY	= 0x20,
+		DT_PREINIT_ARRAYSZ	= 0x21,
+		DT_SYMTAB_SHNDX		= 0x22,
+		DT_RELRSZ			= 0x23,
+		DT_RELR				= 0x24,
+		DT_RELRENT			= 0x25,
+		DT_GNU_HASH			= 0x6FFFFEF5,
+		DT_VERSYM			= 0x6FFFFFF0,
+		DT_RELACOUNT		= 0x6FFFFFF9,
+		DT_RELCOUNT			= 0x6FFFFFFA,
+		DT_FLAGS_1			= 0x6FFFFFFB,
+		DT_VERDEF			= 0x6FFFFFFC,
+		DT_VERDEFNUM		= 0x6FFFFFFD,
+		DT_VERNEED			= 0x6FFFFFFE,
+		DT_VERNEEDNUM		= 0x6FFFFFFF
+	};
+
+	static uint8_t *get_dynamic_tag_name(DynamicTags tag)
+	{
+		switch(tag)
+		{
+			case DynamicTags::DT_NULL: return (uint8_t *) "NULL";break;
+			case DynamicTags::DT_NEEDED: return (uint8_t *) "NEEDED";break;
+			case DynamicTags::DT_PLTRELSZ: return (uint8_t *) "PLTRELSZ";break;
+			case DynamicTags::DT_PLTGOT: return (uint8_t *) "PLTGOT";break;
+			case DynamicTags::DT_HASH: return (uint8_t *) "HASH";break;
+			case DynamicTags::DT_STRTAB: return (uint8_t *) "STRTAB";break;
+			case DynamicTags::DT_SYMTAB: return (uint8_t *) "SYMTAB";break;
+			case DynamicTags::DT_RELA: return (uint8_t *) "RELA";break;
+			case DynamicTags::DT_RELASZ: return (uint8_t *) "RELASZ";break;
+			case DynamicTags::DT_RELAENT: return (uint8_t *) "RELAENT";break;
+			case DynamicTags::DT_STRSZ: return (uint8_t *) "STRSZ";break;
+			case DynamicTags::DT_SYMENT: return (uint8_t *) "SYMENT";break;
+			case DynamicTags::DT_INIT: return (uint8_t *) "INIT";break;
+			case DynamicTags::DT_FINI: return (uint8_t *) "FINI";break;
+			case DynamicTags::DT_SONAME: return (uint8_t *) "SONAME";break;
+			case DynamicTags::DT_RPATH: return (uint8_t *) "RPATH";break;
+			case DynamicTags::DT_SYMBOLIC: return (uint8_t *) "SYMBOLIC";break;
+			case DynamicTags::DT_REL: return (uint8_t *) "REL";break;
+			case DynamicTags::DT_RELSZ: return (uint8_t *) "RELSZ";break;
+			case DynamicTags::DT_RELENT: return (uint8_t *) "RELENT";break;
+			case DynamicTags::DT_PLTREL: return (uint8_t *) "PLTREL";break;
+			case DynamicTags::DT_DEBUG: return (uint8_t *) "DEBUG";break;
+			case DynamicTags::DT_TEXTREL: return (uint8_t *) "TEXTREL";break;
+			case DynamicTags::DT_JMPREL: return (uint8_t *) "JMPREL";break;
+			case DynamicTags::DT_BIND_NOW: return (uint8_t *) "BIND_NOW";break;
+			case DynamicTags::DT_INIT_ARRAY: return (uint8_t *) "INIT_ARRAY";break;
+			case DynamicTags::DT_FINI_ARRAY: return (uint8_t *) "FINI_ARRAY";break;
+			case DynamicTags::DT_INIT_ARRAYSZ: return (uint8_t *) "INIT_ARRAYSZ";break;
+			case DynamicTags::DT_FINI_ARRAYSZ: return (uint8_t *) "FINI_ARRAYSZ";break;
+			case DynamicTags::DT_RUNPATH: return (uint8_t *) "RUNPATH";break;
+			case DynamicTags::DT_FLAGS: return (uint8_t *) "FLAGS";break;
+			case DynamicTags::DT_PREINIT_ARRAY: return (uint8_t *) "PREINIT_ARRAY";break;
+			case DynamicTags::DT_PREINIT_ARRAYSZ: return (uint8_t *) "PREINIT_ARRAYSZ";break;
+			case DynamicTags::DT_SYMTAB_SHNDX: return (uint8_t *) "SYMTAB_SHNDX";break;
+			case DynamicTags::DT_RELRSZ: return (uint8_t *) "RELRSZ";break;
+			case DynamicTags::DT_RELR: return (uint8_t *) "RELR";break;
+			case DynamicTags::DT_RELRENT: return (uint8_t *) "RELRENT";break;
+			case DynamicTags::DT_GNU_HASH: return (uint8_t *) "GNU_HASH";break;
+			case DynamicTags::DT_VERSYM: return (uint8_t *) "VERSYM";break;
+			case DynamicTags::DT_RELACOUNT: return (uint8_t *) "RELACOUNT";break;
+			case DynamicTags::DT_RELCOUNT: return (uint8_t *) "RELCOUNT";break;
+			case DynamicTags::DT_FLAGS_1: return (uint8_t *) "FLAGS_1";break;
+			case DynamicTags::DT_VERDEF: return (uint8_t *) "VERDEF";break;
+			case DynamicTags::DT_VERDEFNUM: return (uint8_t *) "VERDEFNUM";break;
+			case DynamicTags::DT_VERNEED: return (uint8_t *) "VERNEED";break;
+			case DynamicTags::DT_VERNEEDNUM: return (uint8_t *) "VERNEEDNUM";break;
+			default: break;
+		}
+
+		return (uint8_t *) "Unknown Dynamic Tag";
+	}
+
+	/* `DT_FLAGS` bits. */
+	enum class DynamicFlags: uint64_t
+	{
+		DF_ORIGIN			= 0x1,		/* uses `$ORIGIN` */
+		DF_SYMBOLIC			= 0x2,
+		DF_TEXTREL			= 0x4,
+		DF_BIND_NOW			= 0x8,
+		DF_STATIC_TLS		= 0x10
+	};
+
+	/* The dynamic section, found through `PT_DYNAMIC` so stripped binaries without section
+	 * headers decode too, and decoded the first time it is asked for.
+	 *
+	 * Strings (`DT_NEEDED`, `DT_SONAME`, ...) live in the table at `DT_STRTAB`, which is an
+	 * address; it is turned into a file offset through the `PT_LOAD` segment it falls in.
+	 * */
+	class ElfDynamic
+	{
+	public:
+		struct DynamicEntry
+		{
+			uint64_t		d_tag;
+			uint64_t		d_value;
+		};
+
+	protected:
+		ElfSection &elf_sections;
+		uint32_t segment_index;			/* the `PT_DYNAMIC` segment, once the section is decoded */
+
+		ElfArenaArray<struct DynamicEntry> entries;		/* in the file's arena */
+		ElfStringTable dynamic_strings;
+		bool entries_decoded;
+		ElfStatus entries_status;
+
+		template<typename Traits>
+		ElfStatus decode_dynamic_section();
+
+		ElfStatus load_string_table();
+
+		/* The string at the value of the first entry tagged `tag`; empty if there is none. */
+		std::string_view get_tag_string(DynamicTags tag);
+
+	public:
+		/* Nothing is decoded yet. */
+		ElfDynamic(ElfSection &sections);
+
+		/* Start over on whatever file `sections` decodes now. */
+		void reset();
+
+		/* Whether the binary has a dynamic section at all; decodes it to find out. */
+		bool is_present() { get_dynamic_section(); return segment_index < elf_sections.get_program_header_amnt(); }
+
+		ElfStatus get_dynamic_section();
+
+		/* File offset of virtual address `address`, through the `PT_LOAD` segment that holds it.
+		 * Returns false if no segment has it in the file.
+		 * */
+		bool get_file_offset(uint64_t address, uint64_t &offset);
+
+		uint32_t get_entry_amnt() { get_dynamic_section(); return entries.size(); }
+		const struct DynamicEntry &get_entry(uint32_t index) { return entries[index]; }
+
+		/* Value of the first entry tagged `tag`, or `fallback` if there is none. */
+		uint64_t get_value(DynamicTags tag, uint64_t fallback = 0);
+
+		/* Append every `DT_NEEDED` name, in order, to `needed`; returns how many there were. */
+		uint32_t get_needed(std::vector<std::string_view> &needed);
+
+		std::string_view get_soname() { return get_tag_string(DynamicTags::DT_SONAME); }
+		std::string_view get_rpath() { return get_tag_string(DynamicTags::DT_RPATH); }
+		std::string_view get_runpath() { return get_tag_string(DynamicTags::DT_RUNPATH); }
+		uint64_t get_flags() { return get_value(DynamicTags::DT_FLAGS); }
+		uint64_t get_flags_1() { return get_value(DynamicTags::DT_FLAGS_1); }
+
+		void print_dynamic_section(ElfOutput &out);
+		/* `"dynamic":{...}`, for the JSON output formats. */
+		void print_dynamic_section_json(ElfOutput &out);
+
+		template<typename T>
+			requires std::is_same<T, ElfDynamic *>::value
+		void delete_instance(T instance)
+		{
+			if(instance)
+				delete instance;
+			instance = nullptr;
+		}
+
+		~ElfDynamic() = default;
+	};
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef ELF_HASH_H
+#define ELF_HASH_H
+#include "common.hpp"
+#include "elf_symbols.hpp"
+using namespace elf_symbols;
+
+/* Returned by the lookups when there is no such symbol; symbol 0 is never a real symbol. */
+#define ELF_HASH_NOT_FOUND		0
+
+namespace elf_hash
+{
+	/* Looks dynamic symbols up through the hash table the linker already put in the binary
+	 * (`.gnu.hash`, or the older SysV `.hash`), instead of decoding `.dynsym`.
+	 *
+	 * The hash table is read straight from the file. With `.gnu.hash`, the bloom filter rejects
+	 * most names that are not there before any bucket is looked at. Otherwise, only the
+	 * `.dynsym` entries on the name's hash chain (whose hashes match, with `.gnu.hash`) are
+	 * read and have their names compared.
+	 * */
+	class ElfHashTable
+	{
+	protected:
+		ElfSection &elf_sections;
+		uint32_t hash_index;			/* the hash table section */
+		uint32_t symbol_index;			/* the symbol table it indexes (its `sh_link`) */
+		SectionTypes hash_type;
+
+		/* The whole section, and its parts; `layout_table` checks each part is within the section. */
+		ElfSpan table;
+		ElfSpan bloom;					/* `.gnu.hash` only */
+		ElfSpan buckets;
+		ElfSpan chains;
+		uint32_t bucket_amnt;
+		uint64_t chain_amnt;
+		uint32_t symbol_offset;			/* `.gnu.hash` only: the first symbol with a chain entry */
+		uint32_t bloom_amnt;
+		uint32_t bloom_shift;
+		ElfStringTable symbol_names;
+		bool table_loaded;
+		ElfStatus table_status;
+
+		template<typename Traits>
+		ElfStatus layout_table();
+
+		template<typename Traits>
+		uint32_t find_gnu_symbol(std::string_view name, struct ElfSymbolTable::Symbol &symbol);
+		template<typename Traits>
+		uint32_t find_sysv_symbol(std::string_view name, struct ElfSymbolTable::Symbol &symbol);
+
+		/* Read dynamic symbol `index` and check whether it is called `name`. */
+		template<typename Traits>
+		bool is_symbol_named(uint32_t index, std::string_view name, struct ElfSymbolTable::Symbol &symbol);
+
+	public:
+		/* Prefers `.gnu.hash`; nothing is read yet. */
+		ElfHashTable(ElfSection &sections);
+
+		static uint32_t gnu_hash(std::string_view name)
+		{
+			uint32_t hash = 5381;
+
+			for(char c : name)
+				hash = hash * 33 + (uint8_t) c;
+
+			return hash;
+		}
+
+		static uint32_t sysv_hash(std::string_view name)
+		{
+			uint32_t hash = 0;
+
+			for(char c : name)
+			{
+				hash = (hash << 4) + (uint8_t) c;
+
+				uint32_t high = hash & 0xF0000000;
+				hash ^= high >> 24;
+				hash &= ~high;
+			}
+
+			return hash;
+		}
+
+		/* Whether the binary has a hash table at all. */
+		bool is_present() { return hash_index < elf_sections.get_section_amnt(); }
+		SectionTypes get_type() { return hash_type; }
+		std::string_view get_table_name() { return elf_sections.get_section_name(hash_index); }
+
+		/* Read the hash table in and check its header; `find_symbol` does this itself. */
+		ElfStatus load_table();
+
+		/* Index in `.dynsym` of the symbol named `name` (filling in `symbol`), or `ELF_HASH_NOT_FOUND`. */
+		uint32_t find_symbol(std::string_view name, struct ElfSymbolTable::Symbol &symbol);
+
+		/* Whether `symbol` is something other binaries can link against: defined, not local, and visible. */
+		static bool is_exported(const struct ElfSymbolTable::Symbol &symbol)
+		{
+			uint8_t binding = ELF_SYMBOL_BINDING(symbol.st_info);
+			uint8_t visibility = ELF_SYMBOL_VISIBILITY(symbol.st_other);
+
+			return symbol.st_section_index != ELF_SH_UNDEFINED
+				&& binding != (uint8_t) SymbolBindings::STB_LOCAL
+				&& (visibility == (uint8_t) SymbolVisibilities::STV_DEFAULT || visibility == (uint8_t) SymbolVisibilities::STV_PROTECTED);
+		}
+
+		template<typename T>
+			requires std::is_same<T, ElfHashTable *>::value
+		void delete_instance(T instance)
+		{
+			if(instance)
+				delete instance;
+			instance = nullptr;
+		}
+
+		~ElfHashTable() = default;
+	};
+}
+
+#endif
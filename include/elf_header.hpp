@@ -1,15 +1,22 @@
 #ifndef ELF_HEADER_H
 #define ELF_HEADER_H
 #include "common.hpp"
+#include "elf_class.hpp"
+#include "elf_output.hpp"
+using namespace elf_class;
+using namespace elf_output;
 
 #define ELF_MAGIC_NUMBER        0x7F454C46
 #define ELF_CURRENT_VERSION     0x01
 
-/* Structure sizes, per the spec. */
+/* Structure sizes, per the spec (32-bit). The sizes for each class are in `elf_class.hpp`. */
 #define ELF_HEADER_SIZE			0x34
 #define ELF_PROGRAM_HEADER_SIZE	0x20
 #define ELF_SECTION_HEADER_SIZE	0x28
 
+/* Largest possible ELF header (64-bit); read up front in lazy mode. */
+#define ELF_MAX_HEADER_SIZE		0x40
+
 namespace elf_header
 {
     enum class ELF_types: uint8_t
@@ -78,7 +85,7 @@ namespace elf_header
 		return (uint8_t *) "Unknown File Type";
 	}
 
-	enum class ELF_machine_types: uint8_t
+	enum class ELF_machine_types: uint16_t
 	{
 		NoMachine	= 0x0,
 		ATT_WE_32100	= 0x1,
@@ -87,7 +94,15 @@ namespace elf_header
 		Mot68000	= 0x4,		/* Motorola 68000 */
 		Mot88000	= 0x5,		/* Motorola 88000 */
 		Intel80860	= 0x6,
-		MIPS_RS3000	= 0x8
+		MIPS_RS3000	= 0x8,
+		PowerPC		= 0x14,
+		PowerPC64	= 0x15,
+		S390		= 0x16,
+		ARM			= 0x28,
+		SPARCV9		= 0x2B,
+		AMD_X86_64	= 0x3E,
+		AArch64		= 0xB7,
+		RISCV		= 0xF3
 	};
 
 	static uint8_t *get_ELF_machine_type_name(ELF_machine_types machine_type)
@@ -102,39 +117,26 @@ namespace elf_header
 			case ELF_machine_types::Mot88000: return (uint8_t *) "Mot 88000";break;
 			case ELF_machine_types::Intel80860: return (uint8_t *) "Intel 80860";break;
 			case ELF_machine_types::MIPS_RS3000: return (uint8_t *) "MIPS RS3000";break;
+			case ELF_machine_types::PowerPC: return (uint8_t *) "PowerPC";break;
+			case ELF_machine_types::PowerPC64: return (uint8_t *) "PowerPC 64";break;
+			case ELF_machine_types::S390: return (uint8_t *) "IBM S390";break;
+			case ELF_machine_types::ARM: return (uint8_t *) "ARM";break;
+			case ELF_machine_types::SPARCV9: return (uint8_t *) "SPARC V9";break;
+			case ELF_machine_types::AMD_X86_64: return (uint8_t *) "AMD x86-64";break;
+			case ELF_machine_types::AArch64: return (uint8_t *) "AArch64";break;
+			case ELF_machine_types::RISCV: return (uint8_t *) "RISC-V";break;
 			default: break;
 		}
 
 		return (uint8_t *) "Unknown Machine Type";
 	}
 
-	/* All possible errors to encounter. */
-	enum class ELF_errors
-	{
-		Invalid_ELF_Header 	= 0x0,
-		Invalid_ELF_Section	= 0x1,
-		Invalid_ELF_SectionHT	= 0x2,
-		NoError			= 0x3
-	};
-
-	static uint8_t *get_ELF_error_name(ELF_errors error)
-	{
-		switch(error)
-		{
-			case ELF_errors::Invalid_ELF_Header: return (uint8_t *) "Invalid Header";break;
-			case ELF_errors::Invalid_ELF_Section: return (uint8_t *) "Invalid Section";break;
-			case ELF_errors::Invalid_ELF_SectionHT: return (uint8_t *) "Invalid Section Header Table";break;
-			case ELF_errors::NoError: return (uint8_t *) "No Error";break;
-			default: break;
-		}
-
-		return (uint8_t *) "Unknown Error";
-	}
-
     class ElfHeader
 	{
-	private:
-		/* The first 32-bytes of any ELF binary file will be the following. */
+	public:
+		/* The first 52-bytes (32-bit) or 64-bytes (64-bit) of any ELF binary file will be the following.
+		 * Addresses and offsets are widened to 64-bit so both classes decode into the same structure.
+		 * */
 		struct ELF_header
 		{
 			/* First 16-bytes of the ELF binary. */
@@ -148,9 +150,9 @@ namespace elf_header
 			uint16_t	ELF_file_type;
 			uint16_t	ELF_machine_type;
 			uint32_t	ELF_version2;		/* Should be same as `ELF_version`. Idk why it repeates. */
-			uint32_t	ELF_entry;
-			uint32_t	ELF_PH_offset;		/* Program Header offset. */
-			uint32_t	ELF_SH_offset;		/* Section Header offset. */
+			uint64_t	ELF_entry;
+			uint64_t	ELF_PH_offset;		/* Program Header offset. */
+			uint64_t	ELF_SH_offset;		/* Section Header offset. */
 			uint32_t	ELF_flags;		
 			uint16_t	ELF_hsize;			/* Header Size, in bytes. */
 			uint16_t	ELF_PH_entry_size;	/* 1 Entry size, in bytes, of the Program Header Table. */
@@ -177,23 +179,53 @@ namespace elf_header
 	protected:
 		struct ELF_header *elf_header;
 		ElfDecoder *edecoder;
-		int8_t &efilename;
+		int8_t *efilename;
+		bool header_decoded;
+		ElfStatus header_status;
 	
 	public:
-		ElfHeader(FILE *f, int8_t &filename)
-			: efilename(filename), elf_header(nullptr), edecoder(nullptr)
+		ElfHeader(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
+			: elf_header(nullptr), edecoder(nullptr), efilename(&filename), header_decoded(false)
 		{
-			elf_header = new struct ELF_header;
-			edecoder = new ElfDecoder(f);
+			/* The header is decoded the first time anything needs it. */
+			edecoder = new ElfDecoder();
+			ElfHeader::reset(fd, filename, mode);
+		}
 
-			/* Get the ELF header. */
+		/* Start over on another file, keeping the decoder (and its memory).
+		 * If `fd` is not an open file, that is what the header (and so everything else) fails with.
+		 * */
+		ElfStatus reset(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
+		{
+			efilename = &filename;
+			header_status = edecoder->ELF_reset(fd, mode);
+			header_decoded = !header_status;
+
+			/* The header comes first in the file's arena, and every table decoded after it follows. */
+			elf_header = edecoder->ELF_get_arena().allocate<struct ELF_header>(1);
+			*elf_header = ELF_header();
+
+			return header_status;
 		}
 
-		void ELF_get_data(uint8_t length, ELF_parts part, uint8_t &dest);
+		/* Decode the header of a file whose class/byte order is described by `Traits`.
+		 * `raw` must point to at least `Traits::header_size` bytes.
+		 * */
+		template<typename Traits>
+		static void ELF_decode_header(const uint8_t *raw, struct ELF_header &header);
+		static ElfStatus ELF_validate_ident(const uint8_t *ident);
+		static ElfStatus ELF_validate_header(struct ELF_header &header);
+
 		void gather_ELF_heading();
 		//struct ELF_header &get_elf_header();
-		void get_elf_header();
-		void print_elf_header();
+		/* Decode and check the header; if it is broken, nothing else in the file can be decoded either. */
+		ElfStatus get_elf_header();
+		void print_elf_header(ElfOutput &out);
+		/* `"header":{...}`, for the JSON output formats. */
+		void print_elf_header_json(ElfOutput &out);
+
+		ElfDecoder *get_decoder() { return edecoder; }
+		const struct ELF_header &get_header() { get_elf_header(); return *elf_header; }
 
 		template<typename T>
 			requires std::is_same<T, struct ELF_header *>::value
@@ -207,7 +239,7 @@ namespace elf_header
 
 		~ElfHeader()
 		{
-			if(elf_header) delete elf_header;
+			/* The header goes with the decoder's arena. */
 			elf_header = nullptr;
 
 			delete edecoder;
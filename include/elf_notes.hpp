@@ -0,0 +1,183 @@
+#ifndef ELF_NOTES_H
+#define ELF_NOTES_H
+#include "common.hpp"
+#include "elf_sections.hpp"
+using namespace elf_sections;
+
+/* Size of the header every note starts with: name size, description size and type. */
+#define ELF_NOTE_HEADER_SIZE			0xC
+
+/* `NT_GNU_PROPERTY_TYPE_0` properties. */
+#define ELF_PROPERTY_STACK_SIZE			0x1
+#define ELF_PROPERTY_NO_COPY_ON_PROTECTED	0x2
+#define ELF_PROPERTY_AARCH64_FEATURE_1	0xC0000000		/* bits: BTI, PAC */
+#define ELF_PROPERTY_X86_FEATURE_1		0xC0000002		/* bits: IBT, SHSTK */
+#define ELF_PROPERTY_X86_ISA_1_NEEDED	0xC0008002		/* bits: baseline, v2, v3, v4 */
+
+namespace elf_notes
+{
+	/* Types of notes owned by "GNU". */
+	enum class GnuNoteTypes: uint32_t
+	{
+		NT_GNU_ABI_TAG			= 0x1,
+		NT_GNU_HWCAP			= 0x2,
+		NT_GNU_BUILD_ID			= 0x3,
+		NT_GNU_GOLD_VERSION		= 0x4,
+		NT_GNU_PROPERTY_TYPE_0	= 0x5
+	};
+
+	/* Note types only mean something together with their owner. */
+	static uint8_t *get_note_type_name(std::string_view owner, uint32_t type)
+	{
+		if(owner == "GNU")
+		{
+			switch((GnuNoteTypes) type)
+			{
+				case GnuNoteTypes::NT_GNU_ABI_TAG: return (uint8_t *) "ABI Tag";break;
+				case GnuNoteTypes::NT_GNU_HWCAP: return (uint8_t *) "Hardware Capabilities";break;
+				case GnuNoteTypes::NT_GNU_BUILD_ID: return (uint8_t *) "Build ID";break;
+				case GnuNoteTypes::NT_GNU_GOLD_VERSION: return (uint8_t *) "Gold Version";break;
+				case GnuNoteTypes::NT_GNU_PROPERTY_TYPE_0: return (uint8_t *) "Program Properties";break;
+				default: break;
+			}
+		}
+		else if(owner == "CORE")
+		{
+			switch(type)
+			{
+				case 0x1: return (uint8_t *) "Process Status";break;
+				case 0x2: return (uint8_t *) "Floating Point Registers";break;
+				case 0x3: return (uint8_t *) "Process Information";break;
+				case 0x6: return (uint8_t *) "Auxiliary Vector";break;
+				case 0x46494C45: return (uint8_t *) "Mapped Files";break;
+				case 0x53494749: return (uint8_t *) "Signal Information";break;
+				default: break;
+			}
+		}
+		else if(owner == "stapsdt" && type == 0x3)
+			return (uint8_t *) "SystemTap Probe";
+		else if(owner == "FDO" && type == 0xCAFE1A7E)
+			return (uint8_t *) "Packaging Metadata";
+
+		return (uint8_t *) "Unknown Note Type";
+	}
+
+	/* Operating systems in `NT_GNU_ABI_TAG`. */
+	static uint8_t *get_abi_os_name(uint32_t os)
+	{
+		switch(os)
+		{
+			case 0x0: return (uint8_t *) "Linux";break;
+			case 0x1: return (uint8_t *) "Hurd";break;
+			case 0x2: return (uint8_t *) "Solaris";break;
+			case 0x3: return (uint8_t *) "FreeBSD";break;
+			default: break;
+		}
+
+		return (uint8_t *) "Unknown OS";
+	}
+
+	/* Every note in the `SHT_NOTE` sections (or, for files without section headers, the `PT_NOTE`
+	 * segments), read the first time they are asked for. Like `readelf -n`, this includes the
+	 * notes that are not loaded, such as SystemTap probes.
+	 *
+	 * A note is a 12 byte header (name size, description size, type), the owner's name and the
+	 * description, each starting at the alignment of the section they are in (4 bytes, or 8 for
+	 * program properties). Owners and descriptions are kept pointing into the file.
+	 * */
+	class ElfNotes
+	{
+	public:
+		struct Note
+		{
+			std::string_view	owner;
+			uint32_t			type;
+			uint32_t			description_size;
+			const uint8_t		*description;
+		};
+
+		struct AbiTag
+		{
+			uint32_t	os;
+			uint32_t	major;		/* earliest kernel version the binary runs on */
+			uint32_t	minor;
+			uint32_t	patch;
+		};
+
+		/* The `NT_GNU_PROPERTY_TYPE_0` properties this knows about. */
+		struct Properties
+		{
+			uint32_t	x86_features;		/* `ELF_PROPERTY_X86_FEATURE_1` */
+			uint32_t	x86_isa_needed;		/* `ELF_PROPERTY_X86_ISA_1_NEEDED` */
+			uint32_t	aarch64_features;	/* `ELF_PROPERTY_AARCH64_FEATURE_1` */
+			uint64_t	stack_size;			/* `ELF_PROPERTY_STACK_SIZE` */
+		};
+
+	protected:
+		ElfSection &elf_sections;
+		ElfArenaArray<struct Note> notes;		/* in the file's arena */
+		bool notes_decoded;
+		ElfStatus notes_status;
+
+		template<typename Traits>
+		void decode_notes(const ElfSpan &data, uint64_t align);
+		template<typename Traits>
+		void decode_properties(const struct Note &note, struct Properties &properties);
+
+	public:
+		ElfNotes(ElfSection &sections)
+			: elf_sections(sections), notes(sections.get_decoder()->ELF_get_arena()), notes_decoded(false)
+		{}
+
+		/* Start over on whatever file `sections` decodes now. */
+		void reset()
+		{
+			notes.reset();
+			notes_decoded = false;
+			notes_status = ElfStatus();
+		}
+
+		ElfStatus get_notes();
+
+		uint32_t get_note_amnt() { get_notes(); return notes.size(); }
+		const struct Note &get_note(uint32_t index) { return notes[index]; }
+
+		/* The first note of `type` owned by `owner`, or nullptr if there is none. */
+		const struct Note *find_note(std::string_view owner, uint32_t type);
+
+		/* The GNU build ID; empty if there is none. */
+		std::basic_string_view<uint8_t> get_build_id();
+		/* Whether there is a (well-formed) ABI tag; fills in `tag` if so. */
+		bool get_abi_tag(struct AbiTag &tag);
+		/* Whether there are program properties; fills in `properties` if so. */
+		bool get_properties(struct Properties &properties);
+
+		/* The same, for one given note of the right type (a file can have several). */
+		bool get_abi_tag(const struct Note &note, struct AbiTag &tag);
+		void get_properties(const struct Note &note, struct Properties &properties);
+
+		/* Lower-case hex, the way debuggers and `debuginfod` spell build IDs. */
+		static void print_build_id(const uint8_t *build_id, uint32_t size, ElfOutput &out)
+		{
+			for(uint32_t i = 0; i < size; i++)
+				out.character("0123456789abcdef"[build_id[i] >> 4]).character("0123456789abcdef"[build_id[i] & 0xF]);
+		}
+
+		void print_notes(ElfOutput &out);
+		/* `"notes":[...]`, for the JSON output formats. */
+		void print_notes_json(ElfOutput &out);
+
+		template<typename T>
+			requires std::is_same<T, ElfNotes *>::value
+		void delete_instance(T instance)
+		{
+			if(instance)
+				delete instance;
+			instance = nullptr;
+		}
+
+		~ElfNotes() = default;
+	};
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef ELF_OUTPUT_H
+#define ELF_OUTPUT_H
+#include "common.hpp"
+#include <string_view>
+#include <algorithm>
+#include <errno.h>
+
+/* Colors used for the values that were decoded, and for what they mean. */
+#define ELF_COLOR_VALUE			"\e[0;92m"
+#define ELF_COLOR_DESCRIPTION	"\e[0;95m"
+#define ELF_COLOR_RESET			"\e[0;97m"
+
+/* How big the output buffer starts out; one file's report usually fits. */
+#define ELF_OUTPUT_INITIAL_SIZE	0x4000
+
+namespace elf_output
+{
+	/* What the report of each file looks like. */
+	enum class ElfOutputFormats: uint8_t
+	{
+		Text	= 0x0,		/* For people; colored when writing to a terminal. */
+		Json	= 0x1,		/* One JSON array holding an object per file. */
+		Ndjson	= 0x2		/* One JSON object per file, each on its own line. */
+	};
+
+	/* Formats a report into a buffer that is written out with a single `write`.
+	 *
+	 * The buffer only ever grows, so once an `ElfOutput` has been used for a few files
+	 * (each worker thread keeps its own), formatting another one does not allocate.
+	 * Integers are formatted by hand instead of going through `printf`, and with colors
+	 * turned off the color escape codes are left out entirely.
+	 * */
+	class ElfOutput
+	{
+	protected:
+		std::vector<char> buffer;
+		size_t used;
+		bool colors;
+
+		char *reserve(size_t amnt)
+		{
+			if(used + amnt > buffer.size())
+				buffer.resize(std::max(buffer.size() * 2, used + amnt));
+
+			return buffer.data() + used;
+		}
+
+	public:
+		ElfOutput(bool with_colors = true)
+			: buffer(ELF_OUTPUT_INITIAL_SIZE), used(0), colors(with_colors)
+		{}
+
+		/* Colors only make sense when writing to a terminal. */
+		static bool should_use_colors(int fd) { return isatty(fd); }
+
+		void set_colors(bool with_colors) { colors = with_colors; }
+		bool has_colors() { return colors; }
+
+		ElfOutput &text(std::string_view string)
+		{
+			memcpy(reserve(string.size()), string.data(), string.size());
+			used += string.size();
+
+			return *this;
+		}
+
+		ElfOutput &character(char c)
+		{
+			*reserve(1) = c;
+			used++;
+
+			return *this;
+		}
+
+		/* Upper case hexadecimal, without a prefix or leading zeroes (`%X`). */
+		ElfOutput &hex(uint64_t value)
+		{
+			const char digits[] = "0123456789ABCDEF";
+			uint32_t amnt = value ? (67 - std::countl_zero(value)) / 4 : 1;
+			char *to = reserve(amnt);
+
+			for(uint32_t i = amnt; i > 0; i--, value >>= 4)
+				to[i - 1] = digits[value & 0xF];
+			used += amnt;
+
+			return *this;
+		}
+
+		ElfOutput &decimal(uint64_t value)
+		{
+			char digits[20];
+			uint32_t amnt = 0;
+
+			do
+			{
+				digits[sizeof(digits) - ++amnt] = '0' + value % 10;
+				value /= 10;
+			} while(value);
+
+			memcpy(reserve(amnt), digits + sizeof(digits) - amnt, amnt);
+			used += amnt;
+
+			return *this;
+		}
+
+		ElfOutput &color(const char *code)
+		{
+			if(colors)
+				text(code);
+
+			return *this;
+		}
+
+		/* A decoded value: `0x...` in the value color. */
+		ElfOutput &value_hex(uint64_t value)
+		{
+			return color(ELF_COLOR_VALUE).text("0x").hex(value).color(ELF_COLOR_RESET);
+		}
+
+		/* What a value means, in the description color. */
+		ElfOutput &description(std::string_view string)
+		{
+			return color(ELF_COLOR_DESCRIPTION).text(string).color(ELF_COLOR_RESET);
+		}
+
+		/* How long the UTF-8 sequence at `string[i]` is, or 0 if it is not valid UTF-8
+		 * (truncated, overlong, a surrogate or past U+10FFFF).
+		 * */
+		static size_t utf8_sequence_size(std::string_view string, size_t i)
+		{
+			uint8_t c = string[i];
+			size_t size = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+			/* The first byte decides which second bytes are allowed; the ones after it are always `0x80` to `0xBF`. */
+			uint8_t low = c == 0xE0 ? 0xA0 : c == 0xF0 ? 0x90 : 0x80;
+			uint8_t high = c == 0xED ? 0x9F : c == 0xF4 ? 0x8F : 0xBF;
+
+			if(c < 0xC2 || c > 0xF4 || string.size() - i < size)
+				return 0;
+			if((uint8_t) string[i + 1] < low || (uint8_t) string[i + 1] > high)
+				return 0;
+
+			for(size_t j = 2; j < size; j++)
+				if(((uint8_t) string[i + j] & 0xC0) != 0x80)
+					return 0;
+
+			return size;
+		}
+
+		/* A JSON string: `"`, `\\` and control characters are escaped, and so is every byte that is not
+		 * part of valid UTF-8 (as `\u00XX`, names come straight from the file); everything else is copied as is.
+		 * */
+		ElfOutput &json_string(std::string_view string)
+		{
+			const char digits[] = "0123456789abcdef";
+			size_t start = 0;
+
+			character('"');
+
+			for(size_t i = 0; i < string.size(); i++)
+			{
+				uint8_t c = string[i];
+
+				if(c >= 0x20 && c < 0x80 && c != '"' && c != '\\')
+					continue;
+
+				if(c >= 0x80)
+				{
+					size_t size = utf8_sequence_size(string, i);
+
+					if(size > 0)
+					{
+						i += size - 1;
+						continue;
+					}
+				}
+
+				/* Copy everything up to here in one go. */
+				text(string.substr(start, i - start));
+				start = i + 1;
+
+				if(c == '"' || c == '\\')
+					character('\\').character(c);
+				else
+					text("\\u00").character(digits[c >> 4]).character(digits[c & 0xF]);
+			}
+
+			return text(string.substr(start)).character('"');
+		}
+
+		/* `"key":`; keys are always plain ASCII, so they do not need escaping. */
+		ElfOutput &json_key(const char *key)
+		{
+			return character('"').text(key).text("\":");
+		}
+
+		const char *get_data() { return buffer.data(); }
+		size_t get_size() { return used; }
+		void clear() { used = 0; }
+
+		/* Hand the buffer over (e.g. to be written out later), getting `other`'s storage to reuse in return. */
+		void swap_buffer(std::vector<char> &other, size_t &other_size)
+		{
+			buffer.swap(other);
+			std::swap(used, other_size);
+		}
+
+		/* Write everything out to `fd` and start over. */
+		void flush(int fd)
+		{
+			write_all(fd, buffer.data(), used);
+			used = 0;
+		}
+
+		static void write_all(int fd, const char *data, size_t size)
+		{
+			while(size > 0)
+			{
+				ssize_t written = write(fd, data, size);
+
+				if(written < 0 && errno == EINTR)
+					continue;
+
+				ELF_ASSERT(written > 0,
+					"\nUnable to write the output (%s).\n",
+					strerror(errno))
+
+				data += written;
+				size -= written;
+			}
+		}
+
+		~ElfOutput() = default;
+	};
+}
+
+#endif
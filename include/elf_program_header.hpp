@@ -14,6 +14,11 @@ namespace elf_program_header
         ST_NOTE,    /* array element specifies the location and size of auxiliar information */
         ST_SHLIB,   /* ignore */
         ST_PHDR,    /* array element, if present, specifies the location and size of the program header table itself */
+        ST_TLS,     /* array element specifies the thread-local storage template */
+        ST_GNU_EH_FRAME = 0x6474E550,   /* location of the `.eh_frame_hdr` section */
+        ST_GNU_STACK    = 0x6474E551,   /* flags tell whether the stack should be executable */
+        ST_GNU_RELRO    = 0x6474E552,   /* region to make read-only after relocation */
+        ST_GNU_PROPERTY = 0x6474E553,   /* location of the `.note.gnu.property` section */
         ST_LOPROC = 0x70000000,  /* processor-specific semantics */
         ST_HIPROC = 0x7FFFFFFF,  /* processor-specific semantics */
     };
@@ -29,6 +34,11 @@ namespace elf_program_header
             case SegmentTypes::ST_NOTE: return (uint8_t *) "Entry Describing Location And Size Of Auxiliar Information";break;
             case SegmentTypes::ST_SHLIB: return (uint8_t *) "Reserved Entry Type";break;
             case SegmentTypes::ST_PHDR: return (uint8_t *) "Entry Describing Location And Size Of Program Header Table";break;
+            case SegmentTypes::ST_TLS: return (uint8_t *) "Entry Describing The Thread-Local Storage Template";break;
+            case SegmentTypes::ST_GNU_EH_FRAME: return (uint8_t *) "GNU Exception Handling Frame Header";break;
+            case SegmentTypes::ST_GNU_STACK: return (uint8_t *) "GNU Stack Permissions";break;
+            case SegmentTypes::ST_GNU_RELRO: return (uint8_t *) "GNU Read-only After Relocation";break;
+            case SegmentTypes::ST_GNU_PROPERTY: return (uint8_t *) "GNU Property Notes";break;
             case SegmentTypes::ST_LOPROC: return (uint8_t *) "Processor-specific";break;
             case SegmentTypes::ST_HIPROC: return (uint8_t *) "Processor-specific";break;
             default: break;
@@ -43,58 +53,80 @@ namespace elf_program_header
         NoAlignment2 = 0x00000001
     };
 
+    /* Segment permissions (`p_flags`). */
+    enum class SegmentFlags: uint32_t
+    {
+        SF_EXECUTE  = 0x1,
+        SF_WRITE    = 0x2,
+        SF_READ     = 0x4
+    };
+
+    /* `e_phnum` value saying the real amount of entries is in `sh_info` of section header 0. */
+    #define ELF_PH_EXTENDED_NUMBERING   0xFFFF
+
     class ElfProgramHeader : public ElfHeader
     {
-    private:
+    public:
+        /* Offsets, addresses and sizes are widened to 64-bit so both classes decode into the same structure.
+         * The fields are ordered like a 64-bit entry in the file, so for 64-bit files in the host's byte
+         * order the table in the file is used as-is instead of being decoded.
+         * */
         struct ProgramHeader
         {
             uint32_t        p_type;
-            uint32_t        p_offset;
-            uint32_t        p_virtual_address;
-            uint32_t        p_physical_address;
-            uint32_t        p_size;                 /* number of bytes in the file image of the segment */
-            uint32_t        p_memory_size;          /* number of bytes in the memory image of the segment */
             uint32_t        p_flags;                /* flags relevant to the segment */
-            uint32_t        p_align;
+            uint64_t        p_offset;
+            uint64_t        p_virtual_address;
+            uint64_t        p_physical_address;
+            uint64_t        p_size;                 /* number of bytes in the file image of the segment */
+            uint64_t        p_memory_size;          /* number of bytes in the memory image of the segment */
+            uint64_t        p_align;
 
             ProgramHeader() = default;
             ~ProgramHeader() = default;
         };
-    
+        static_assert(sizeof(struct ProgramHeader) == sizeof(struct ELF64_raw_program_header)
+            && offsetof(struct ProgramHeader, p_flags) == offsetof(struct ELF64_raw_program_header, p_flags)
+            && offsetof(struct ProgramHeader, p_align) == offsetof(struct ELF64_raw_program_header, p_align));
+
     protected:
-        struct ProgramHeader **pheader;
-        uint16_t index;
+        /* `pheader_amnt` contiguous entries, either pointing into the file or decoded into the file's arena. */
+        const struct ProgramHeader *pheader;
+        uint32_t pheader_amnt;
+        bool pheader_decoded;
+        ElfStatus pheader_status;
+
+        template<typename Traits>
+        ElfStatus decode_program_header_table();
 
     public:
         ElfProgramHeader() = default;
-        ElfProgramHeader(FILE *f, int8_t &filename)
-            : pheader(nullptr), index(0), ElfHeader(f, filename)
+        ElfProgramHeader(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
+            : ElfHeader(fd, filename, mode), pheader(nullptr), pheader_amnt(0), pheader_decoded(false)
+        {}
+
+        ElfStatus reset(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
         {
-            pheader = new struct ProgramHeader *;
-            pheader[index] = new struct ProgramHeader;
+            pheader = nullptr;
+            pheader_amnt = 0;
+            pheader_decoded = false;
+            pheader_status = ElfStatus();
 
-            get_elf_header();
-            print_elf_header();
+            return ElfHeader::reset(fd, filename, mode);
         }
 
-        void ELF_get_data(uint8_t length, ELF_parts part, uint8_t &dest);
-        void get_program_header_table();
-        void print_elf_program_header_table();
+        ElfStatus get_program_header_table();
+        void print_elf_program_header_table(ElfOutput &out);
+        /* `"program_headers":[...]`, for the JSON output formats. */
+        void print_elf_program_header_table_json(ElfOutput &out);
+
+        uint32_t get_program_header_amnt() { get_program_header_table(); return pheader_amnt; }
+        const struct ProgramHeader &get_program_header(uint32_t index) { return pheader[index]; }
 
         ~ElfProgramHeader()
         {
-            /* If a Program Header doesn't exist in a ELF binary file, `pheader` will be deleted in `get_program_header_entries`. */
-            if(pheader)
-            {
-                for(uint16_t i = 0; i <= index; i++)
-                {
-                    delete pheader[index];
-                    pheader[index] = nullptr;
-                }
-            
-                delete pheader;
-                pheader = nullptr;
-            }
+            /* The table goes with the decoder's arena. */
+            pheader = nullptr;
         }
     };
 }
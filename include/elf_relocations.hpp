@@ -0,0 +1,218 @@
+#ifndef ELF_RELOCATIONS_H
+#define ELF_RELOCATIONS_H
+#include "common.hpp"
+#include "elf_sections.hpp"
+#include <functional>
+using namespace elf_sections;
+
+/* How many relocations get decoded at a time; small enough for a block to stay in L1. */
+#define ELF_RELOCATION_BLOCK_SIZE		256
+/* Relocation types at or above this are counted together in the histogram. */
+#define ELF_RELOCATION_MAX_TYPE			0x1000
+
+namespace elf_relocations
+{
+	/* The types that mean something to the summary; they differ per machine. */
+	struct MachineRelocationTypes
+	{
+		uint32_t	copy;			/* `R_*_COPY`: copies data out of a shared object into the executable */
+		uint32_t	relative;		/* `R_*_RELATIVE`: base address + addend, no symbol lookup */
+	};
+
+	/* Returns false for machines without known relocation types. */
+	static bool get_machine_relocation_types(ELF_machine_types machine, struct MachineRelocationTypes &types)
+	{
+		switch(machine)
+		{
+			case ELF_machine_types::Intel80386: types = { 5, 8 }; return true;
+			case ELF_machine_types::AMD_X86_64: types = { 5, 8 }; return true;
+			case ELF_machine_types::ARM: types = { 20, 23 }; return true;
+			case ELF_machine_types::AArch64: types = { 1024, 1027 }; return true;
+			case ELF_machine_types::PowerPC: types = { 19, 22 }; return true;
+			case ELF_machine_types::PowerPC64: types = { 19, 22 }; return true;
+			case ELF_machine_types::S390: types = { 9, 12 }; return true;
+			case ELF_machine_types::RISCV: types = { 4, 3 }; return true;
+			default: break;
+		}
+
+		return false;
+	}
+
+	static uint8_t *get_relocation_type_name(ELF_machine_types machine, uint32_t type)
+	{
+		if(machine == ELF_machine_types::AMD_X86_64)
+		{
+			switch(type)
+			{
+				case 0: return (uint8_t *) "R_X86_64_NONE";break;
+				case 1: return (uint8_t *) "R_X86_64_64";break;
+				case 2: return (uint8_t *) "R_X86_64_PC32";break;
+				case 3: return (uint8_t *) "R_X86_64_GOT32";break;
+				case 4: return (uint8_t *) "R_X86_64_PLT32";break;
+				case 5: return (uint8_t *) "R_X86_64_COPY";break;
+				case 6: return (uint8_t *) "R_X86_64_GLOB_DAT";break;
+				case 7: return (uint8_t *) "R_X86_64_JUMP_SLOT";break;
+				case 8: return (uint8_t *) "R_X86_64_RELATIVE";break;
+				case 9: return (uint8_t *) "R_X86_64_GOTPCREL";break;
+				case 10: return (uint8_t *) "R_X86_64_32";break;
+				case 11: return (uint8_t *) "R_X86_64_32S";break;
+				case 16: return (uint8_t *) "R_X86_64_DTPMOD64";break;
+				case 17: return (uint8_t *) "R_X86_64_DTPOFF64";break;
+				case 18: return (uint8_t *) "R_X86_64_TPOFF64";break;
+				case 24: return (uint8_t *) "R_X86_64_PC64";break;
+				case 36: return (uint8_t *) "R_X86_64_TLSDESC";break;
+				case 37: return (uint8_t *) "R_X86_64_IRELATIVE";break;
+				case 41: return (uint8_t *) "R_X86_64_GOTPCRELX";break;
+				case 42: return (uint8_t *) "R_X86_64_REX_GOTPCRELX";break;
+				default: break;
+			}
+		}
+		else if(machine == ELF_machine_types::Intel80386)
+		{
+			switch(type)
+			{
+				case 0: return (uint8_t *) "R_386_NONE";break;
+				case 1: return (uint8_t *) "R_386_32";break;
+				case 2: return (uint8_t *) "R_386_PC32";break;
+				case 3: return (uint8_t *) "R_386_GOT32";break;
+				case 4: return (uint8_t *) "R_386_PLT32";break;
+				case 5: return (uint8_t *) "R_386_COPY";break;
+				case 6: return (uint8_t *) "R_386_GLOB_DAT";break;
+				case 7: return (uint8_t *) "R_386_JMP_SLOT";break;
+				case 8: return (uint8_t *) "R_386_RELATIVE";break;
+				case 9: return (uint8_t *) "R_386_GOTOFF";break;
+				case 10: return (uint8_t *) "R_386_GOTPC";break;
+				case 14: return (uint8_t *) "R_386_TLS_TPOFF";break;
+				case 35: return (uint8_t *) "R_386_TLS_DTPMOD32";break;
+				case 36: return (uint8_t *) "R_386_TLS_DTPOFF32";break;
+				case 42: return (uint8_t *) "R_386_IRELATIVE";break;
+				case 43: return (uint8_t *) "R_386_GOT32X";break;
+				default: break;
+			}
+		}
+		else if(machine == ELF_machine_types::AArch64)
+		{
+			switch(type)
+			{
+				case 0: return (uint8_t *) "R_AARCH64_NONE";break;
+				case 257: return (uint8_t *) "R_AARCH64_ABS64";break;
+				case 1024: return (uint8_t *) "R_AARCH64_COPY";break;
+				case 1025: return (uint8_t *) "R_AARCH64_GLOB_DAT";break;
+				case 1026: return (uint8_t *) "R_AARCH64_JUMP_SLOT";break;
+				case 1027: return (uint8_t *) "R_AARCH64_RELATIVE";break;
+				case 1030: return (uint8_t *) "R_AARCH64_TLS_TPREL64";break;
+				case 1031: return (uint8_t *) "R_AARCH64_TLSDESC";break;
+				case 1032: return (uint8_t *) "R_AARCH64_IRELATIVE";break;
+				default: break;
+			}
+		}
+
+		return (uint8_t *) "Unknown Relocation Type";
+	}
+
+	/* Decodes every relocation section (`SHT_REL`, `SHT_RELA` and `SHT_RELR`) into a summary,
+	 * optionally handing every relocation to a callback along the way.
+	 *
+	 * Each section is checked to be within the file once, then decoded `ELF_RELOCATION_BLOCK_SIZE`
+	 * entries at a time into a structure of arrays. 64-bit entries in the host's byte order are
+	 * unpacked two at a time with SIMD shuffles; the others are read a field at a time, with a
+	 * `bswap` when the byte order differs. Nothing is kept once a block has been counted, so the
+	 * memory used does not grow with the amount of relocations.
+	 * */
+	class ElfRelocations
+	{
+	public:
+		/* One block of decoded relocations, all from the same section. */
+		struct RelocationBlock
+		{
+			uint64_t	offsets[ELF_RELOCATION_BLOCK_SIZE];
+			int64_t		addends[ELF_RELOCATION_BLOCK_SIZE];		/* 0 for `SHT_REL`/`SHT_RELR` */
+			uint32_t	types[ELF_RELOCATION_BLOCK_SIZE];
+			uint32_t	symbols[ELF_RELOCATION_BLOCK_SIZE];
+			uint32_t	amnt;
+			uint32_t	section;
+		};
+
+		struct RelocationSummary
+		{
+			uint64_t				relocation_amnt;
+			uint64_t				dynamic_amnt;		/* in allocated sections: applied by the dynamic linker at startup */
+			uint64_t				relative_amnt;		/* `R_*_RELATIVE`, including the ones packed in `SHT_RELR` */
+			uint64_t				relr_amnt;			/* packed in `SHT_RELR` sections */
+			uint64_t				copy_amnt;			/* `R_*_COPY` */
+			uint64_t				text_amnt;			/* dynamic relocations of read-only segments (`TEXTREL`) */
+			uint32_t				section_amnt;		/* relocation sections */
+			uint64_t				*type_counts;		/* by type, in the file's arena; the last one counts every type past `ELF_RELOCATION_MAX_TYPE` */
+		};
+
+		using block_function = std::function<void (const struct RelocationBlock &block)>;
+
+	protected:
+		ElfSection &elf_sections;
+		struct RelocationSummary summary;
+		struct MachineRelocationTypes machine_types;
+		bool machine_known;
+		bool summary_decoded;
+
+		struct address_range
+		{
+			uint64_t	address;
+			uint64_t	size;
+		};
+
+		/* Every loadable segment that is not writable, in the file's arena. */
+		ElfArenaArray<struct address_range> read_only_ranges;
+
+		template<typename Traits, typename Entry>
+		void decode_relocation_section(uint32_t section, const ElfSpan &table, uint64_t entry_size, uint64_t amnt, const block_function &handle_block);
+		template<typename Traits>
+		void decode_relr_section(uint32_t section, const ElfSpan &table, uint64_t amnt, const block_function &handle_block);
+		template<typename Traits>
+		ElfStatus validate_sections();
+		template<typename Traits>
+		ElfStatus decode_relocations(const block_function &handle_block);
+
+		void count_block(const struct RelocationBlock &block, bool dynamic, bool packed);
+
+	public:
+		ElfRelocations(ElfSection &sections);
+
+		/* Start over on whatever file `sections` decodes now. */
+		void reset()
+		{
+			summary = {};
+			machine_known = false;
+			summary_decoded = false;
+			read_only_ranges.reset();
+		}
+
+		/* Check that every relocation section has entries big enough and is within the file; nothing is read in. */
+		ElfStatus validate();
+
+		/* Decode every relocation section, calling `handle_block` (if set) for each block of relocations. */
+		ElfStatus decode_all(block_function handle_block = nullptr);
+
+		const struct RelocationSummary &get_summary() { if(!summary_decoded) decode_all(); return summary; }
+
+		void print_relocation_summary(ElfOutput &out);
+		/* Every relocation, one per line. */
+		void print_relocation_list(ElfOutput &out);
+		/* `"relocations":{...}`, for the JSON output formats. */
+		void print_relocation_summary_json(ElfOutput &out);
+		/* `"relocation_list":[...]`, for the JSON output formats. */
+		void print_relocation_list_json(ElfOutput &out);
+
+		template<typename T>
+			requires std::is_same<T, ElfRelocations *>::value
+		void delete_instance(T instance)
+		{
+			if(instance)
+				delete instance;
+			instance = nullptr;
+		}
+
+		~ElfRelocations() = default;
+	};
+}
+
+#endif
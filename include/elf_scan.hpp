@@ -0,0 +1,79 @@
+#ifndef ELF_SCAN_H
+#define ELF_SCAN_H
+#include "common.hpp"
+#include "elf_header.hpp"
+#include <set>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+/* What a file that was not already known gets for its tag. */
+#define ELF_SCAN_NO_TAG			UINT64_MAX
+
+namespace elf_scan
+{
+	/* An ELF binary file the scan found, and the tag it was given if it was already known. */
+	struct ElfScannedFile
+	{
+		std::string		path;
+		uint64_t		tag;
+
+		bool operator<(const struct ElfScannedFile &other) const { return path < other.path; }
+	};
+
+	/* Walks directory trees on a pool of threads, collecting every ELF binary file.
+	 *
+	 * Only regular files are looked at; a file counts as an ELF binary file if its first 4
+	 * bytes are `ELF_MAGIC_NUMBER`, which is the only read done on it. Symbolic links are not
+	 * followed (the files they point to are reached through their real path), special files
+	 * (FIFOs, sockets, devices) are never opened, and each directory is only walked once even
+	 * if bind mounts make it reachable more than once.
+	 * */
+	class ElfDirectoryScan
+	{
+	public:
+		/* Whether `name` (relative to the directory `directory_fd`) is already known to be an ELF binary file.
+		 * It can set `tag` to whatever it found out about the file, so it does not have to be looked up again.
+		 * */
+		using known_function = std::function<bool (int directory_fd, const char *name, uint64_t &tag)>;
+
+	protected:
+		uint32_t worker_amnt;
+		known_function is_known;
+
+		/* Guards everything below. */
+		std::mutex lock;
+		std::condition_variable work_available;
+		std::deque<std::string> directories;
+		std::set<std::pair<dev_t, ino_t>> visited;
+		uint32_t busy_workers;
+
+		std::vector<struct ElfScannedFile> elf_files;
+
+		void run_worker();
+		void scan_directory(const std::string &path, std::vector<std::string> &subdirectories, std::vector<struct ElfScannedFile> &found);
+		bool add_directory(dev_t device, ino_t inode);
+
+	public:
+		/* `workers` of 0 means one worker per core. */
+		ElfDirectoryScan(uint32_t workers = 0);
+
+		/* Check the first 4 bytes of `name` (relative to the directory `directory_fd`). */
+		static bool is_elf_file(int directory_fd, const char *name);
+
+		/* Files `known` says yes to are taken as ELF binary files without reading them.
+		 * It gets called from every worker at once.
+		 * */
+		void set_known_files(known_function known) { is_known = std::move(known); }
+
+		/* Walk `root`; the ELF binary files found are added, sorted, to `files`. */
+		void scan(const char *root, std::vector<struct ElfScannedFile> &files);
+
+		~ElfDirectoryScan() = default;
+	};
+}
+
+#endif
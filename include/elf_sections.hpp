@@ -2,23 +2,180 @@
 #define ELF_SECTIONS_H
 #include "common.hpp"
 #include "elf_program_header.hpp"
+#include "elf_string_table.hpp"
 
 using namespace elf_program_header;
+using namespace elf_string_table;
+
+/* Special section indexes. */
+#define ELF_SH_UNDEFINED			0x0
+#define ELF_SH_EXTENDED_INDEX		0xFFFF		/* The real index is in `sh_link` of section header 0. */
 
 namespace elf_sections
 {
-    /* Section data that belongs to each segment found in the ELF binary. */
+    enum class SectionTypes: uint32_t
+	{
+		SHT_NULL			= 0x0,
+		SHT_PROGBITS		= 0x1,
+		SHT_SYMTAB			= 0x2,
+		SHT_STRTAB			= 0x3,
+		SHT_RELA			= 0x4,
+		SHT_HASH			= 0x5,
+		SHT_DYNAMIC			= 0x6,
+		SHT_NOTE			= 0x7,
+		SHT_NOBITS			= 0x8,
+		SHT_REL				= 0x9,
+		SHT_SHLIB			= 0xA,
+		SHT_DYNSYM			= 0xB,
+		SHT_INIT_ARRAY		= 0xE,
+		SHT_FINI_ARRAY		= 0xF,
+		SHT_PREINIT_ARRAY	= 0x10,
+		SHT_GROUP			= 0x11,
+		SHT_SYMTAB_SHNDX	= 0x12,
+		SHT_RELR			= 0x13,
+		SHT_GNU_ATTRIBUTES	= 0x6FFFFFF5,
+		SHT_GNU_HASH		= 0x6FFFFFF6,
+		SHT_GNU_VERDEF		= 0x6FFFFFFD,
+		SHT_GNU_VERNEED		= 0x6FFFFFFE,
+		SHT_GNU_VERSYM		= 0x6FFFFFFF
+	};
+
+	static uint8_t *get_section_type_name(SectionTypes stype)
+	{
+		switch(stype)
+		{
+			case SectionTypes::SHT_NULL: return (uint8_t *) "Unused Entry";break;
+			case SectionTypes::SHT_PROGBITS: return (uint8_t *) "Program Data";break;
+			case SectionTypes::SHT_SYMTAB: return (uint8_t *) "Symbol Table";break;
+			case SectionTypes::SHT_STRTAB: return (uint8_t *) "String Table";break;
+			case SectionTypes::SHT_RELA: return (uint8_t *) "Relocations With Addends";break;
+			case SectionTypes::SHT_HASH: return (uint8_t *) "Symbol Hash Table";break;
+			case SectionTypes::SHT_DYNAMIC: return (uint8_t *) "Dynamic Linking Information";break;
+			case SectionTypes::SHT_NOTE: return (uint8_t *) "Notes";break;
+			case SectionTypes::SHT_NOBITS: return (uint8_t *) "Program Space With No Data (bss)";break;
+			case SectionTypes::SHT_REL: return (uint8_t *) "Relocations";break;
+			case SectionTypes::SHT_SHLIB: return (uint8_t *) "Reserved Entry Type";break;
+			case SectionTypes::SHT_DYNSYM: return (uint8_t *) "Dynamic Linker Symbol Table";break;
+			case SectionTypes::SHT_INIT_ARRAY: return (uint8_t *) "Array Of Constructors";break;
+			case SectionTypes::SHT_FINI_ARRAY: return (uint8_t *) "Array Of Destructors";break;
+			case SectionTypes::SHT_PREINIT_ARRAY: return (uint8_t *) "Array Of Pre-constructors";break;
+			case SectionTypes::SHT_GROUP: return (uint8_t *) "Section Group";break;
+			case SectionTypes::SHT_SYMTAB_SHNDX: return (uint8_t *) "Extended Section Indexes";break;
+			case SectionTypes::SHT_RELR: return (uint8_t *) "Relative Relocations (Compact)";break;
+			case SectionTypes::SHT_GNU_ATTRIBUTES: return (uint8_t *) "GNU Object Attributes";break;
+			case SectionTypes::SHT_GNU_HASH: return (uint8_t *) "GNU Symbol Hash Table";break;
+			case SectionTypes::SHT_GNU_VERDEF: return (uint8_t *) "GNU Version Definitions";break;
+			case SectionTypes::SHT_GNU_VERNEED: return (uint8_t *) "GNU Version Requirements";break;
+			case SectionTypes::SHT_GNU_VERSYM: return (uint8_t *) "GNU Symbol Versions";break;
+			default: break;
+		}
+
+		return (uint8_t *) "Unknown Section Type";
+	}
+
+	enum class SectionFlags: uint64_t
+	{
+		SF_WRITE			= 0x1,
+		SF_ALLOC			= 0x2,		/* occupies memory during execution */
+		SF_EXECINSTR		= 0x4,
+		SF_MERGE			= 0x10,
+		SF_STRINGS			= 0x20,
+		SF_INFO_LINK		= 0x40,		/* `sh_info` holds a section index */
+		SF_LINK_ORDER		= 0x80,
+		SF_OS_NONCONFORMING	= 0x100,
+		SF_GROUP			= 0x200,
+		SF_TLS				= 0x400,
+		SF_COMPRESSED		= 0x800
+	};
+
+    /* Section data that belongs to each segment found in the ELF binary.
+	 *
+	 * The section header table is kept as a structure of arrays: each field of every section
+	 * lives in its own array, indexed by section number. Filters over huge tables (e.g. "every
+	 * allocated section") then only walk the arrays they need. The arrays are in the file's arena,
+	 * one after the other.
+	 * */
 	class ElfSection : public ElfProgramHeader
 	{
+	public:
+		struct SectionTable
+		{
+			uint32_t	*names;			/* offset of the name in the section name string table */
+			uint32_t	*types;
+			uint64_t	*flags;
+			uint64_t	*addresses;
+			uint64_t	*offsets;
+			uint64_t	*sizes;
+			uint32_t	*links;
+			uint32_t	*infos;
+			uint64_t	*alignments;
+			uint64_t	*entry_sizes;
+		};
+
+	protected:
+		struct SectionTable sections;
+		uint32_t section_amnt;
+		uint32_t section_str_index;
+		bool sections_decoded;
+		ElfStatus sections_status;
+
+		/* `.shstrtab`, set up the first time a section name is asked for. */
+		ElfStringTable section_names;
+		bool section_names_loaded;
+
+		template<typename Traits>
+		ElfStatus decode_section_header_table();
+
 	public:
         ElfSection() = default;
-		ElfSection(FILE *f, int8_t &filename)
-			: ElfProgramHeader(f, filename)
+
+		/* Nothing past the ELF header gets decoded until it is asked for. */
+		ElfSection(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
+			: ElfProgramHeader(fd, filename, mode),
+			  sections(), section_amnt(0), section_str_index(ELF_SH_UNDEFINED), sections_decoded(false), section_names_loaded(false)
+		{}
+
+		/* Start over on another file. */
+		ElfStatus reset(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
 		{
-			get_program_header_table();
-			print_elf_program_header_table();
+			sections = SectionTable();
+			section_amnt = 0;
+			section_str_index = ELF_SH_UNDEFINED;
+			sections_decoded = false;
+			sections_status = ElfStatus();
+			section_names = ElfStringTable();
+			section_names_loaded = false;
+
+			return ElfProgramHeader::reset(fd, filename, mode);
 		}
 
+		ElfStatus get_section_header_table();
+		void print_elf_section_header_table(ElfOutput &out);
+		/* `"sections":[...]`, for the JSON output formats. */
+		void print_elf_section_header_table_json(ElfOutput &out);
+
+		uint32_t get_section_amnt() { get_section_header_table(); return section_amnt; }
+		uint32_t get_section_str_index() { get_section_header_table(); return section_str_index; }
+		const struct SectionTable &get_sections() { get_section_header_table(); return sections; }
+
+		/* View the contents of string table section `index` in place; empty if it is not a string table. */
+		ElfStringTable get_string_table(uint32_t index);
+
+		/* Name of section `index`, pointing into `.shstrtab`. */
+		std::string_view get_section_name(uint32_t index);
+
+		/* Index of the first section named `name`, or `section_amnt` if there is none. */
+		uint32_t find_section_by_name(std::string_view name);
+
+		/* Index of the first section of type `type` at or after `start`, or `section_amnt` if there is none. */
+		uint32_t find_section_by_type(SectionTypes type, uint32_t start = 0);
+
+		/* Append the index of every section that has all of `flags` set to `indexes`; returns how many matched. */
+		uint32_t get_sections_with_flags(uint64_t flags, std::vector<uint32_t> &indexes);
+
+		/* Total `sh_size` of every section of type `type`. */
+		uint64_t get_total_size_by_type(SectionTypes type);
+
 		template<typename T>
 			requires std::is_same<T, ElfSection *>::value
 		void delete_instance(T instance)
@@ -32,4 +189,4 @@ namespace elf_sections
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
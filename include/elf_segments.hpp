@@ -11,8 +11,8 @@ namespace elf_segments
 	{
 	public:
         ElfSegment() = default;
-		ElfSegment(FILE *f, int8_t &filename)
-			: ElfSection(f, filename)
+		ElfSegment(int fd, int8_t &filename, ELF_load_modes mode = ELF_load_modes::Mapped)
+			: ElfSection(fd, filename, mode)
 		{}
 
 		template<typename T>
@@ -0,0 +1,52 @@
+#ifndef ELF_STRING_TABLE_H
+#define ELF_STRING_TABLE_H
+#include "common.hpp"
+#include <string_view>
+
+namespace elf_string_table
+{
+	/* A string table section (`.shstrtab`, `.strtab`, `.dynstr`...) viewed in place.
+	 *
+	 * The table is checked once, when it is created: everything after its last NUL byte is
+	 * ignored, so every string that starts inside the table is guaranteed to end inside it.
+	 * Lookups then hand out `std::string_view`s pointing straight into the file, without copying.
+	 * */
+	class ElfStringTable
+	{
+	protected:
+		const char *table;
+		size_t table_size;
+
+	public:
+		ElfStringTable()
+			: table(nullptr), table_size(0)
+		{}
+
+		ElfStringTable(const uint8_t *data, size_t size)
+			: table((const char *) data), table_size(0)
+		{
+			const void *last_nul = size > 0 ? memrchr(data, '\0', size) : nullptr;
+
+			if(last_nul)
+				table_size = (const uint8_t *) last_nul - data + 1;
+		}
+
+		/* The string at `offset`, or an empty string if `offset` is not inside the table.
+		 * Offsets are taken as 64-bit, since some (like the dynamic section's) come from 64-bit fields.
+		 * */
+		std::string_view get_string(uint64_t offset) const
+		{
+			if(offset >= table_size)
+				return std::string_view();
+
+			return std::string_view(table + offset);
+		}
+
+		bool is_empty() const { return table_size == 0; }
+		size_t get_size() const { return table_size; }
+
+		~ElfStringTable() = default;
+	};
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef ELF_SYMBOLS_H
+#define ELF_SYMBOLS_H
+#include "common.hpp"
+#include "elf_sections.hpp"
+using namespace elf_sections;
+
+/* Special section indexes a symbol can be defined in. */
+#define ELF_SH_ABSOLUTE					0xFFF1
+#define ELF_SH_COMMON					0xFFF2
+
+#define ELF_SYMBOL_TYPE(info)			((info) & 0xF)
+#define ELF_SYMBOL_BINDING(info)		((info) >> 4)
+#define ELF_SYMBOL_VISIBILITY(other)	((other) & 0x3)
+
+/* Most symbols a table can have; the name index needs twice as many slots, which still fit in 32 bits. */
+#define ELF_SYMBOLS_MAX					0x40000000
+
+namespace elf_symbols
+{
+	enum class SymbolTypes: uint8_t
+	{
+		STT_NOTYPE		= 0x0,
+		STT_OBJECT		= 0x1,
+		STT_FUNC		= 0x2,
+		STT_SECTION		= 0x3,
+		STT_FILE		= 0x4,
+		STT_COMMON		= 0x5,
+		STT_TLS			= 0x6,
+		STT_GNU_IFUNC	= 0xA
+	};
+
+	static uint8_t *get_symbol_type_name(SymbolTypes type)
+	{
+		switch(type)
+		{
+			case SymbolTypes::STT_NOTYPE: return (uint8_t *) "No Type";break;
+			case SymbolTypes::STT_OBJECT: return (uint8_t *) "Object";break;
+			case SymbolTypes::STT_FUNC: return (uint8_t *) "Function";break;
+			case SymbolTypes::STT_SECTION: return (uint8_t *) "Section";break;
+			case SymbolTypes::STT_FILE: return (uint8_t *) "File";break;
+			case SymbolTypes::STT_COMMON: return (uint8_t *) "Common Object";break;
+			case SymbolTypes::STT_TLS: return (uint8_t *) "Thread-Local Object";break;
+			case SymbolTypes::STT_GNU_IFUNC: return (uint8_t *) "GNU Indirect Function";break;
+			default: break;
+		}
+
+		return (uint8_t *) "Unknown Symbol Type";
+	}
+
+	enum class SymbolBindings: uint8_t
+	{
+		STB_LOCAL		= 0x0,
+		STB_GLOBAL		= 0x1,
+		STB_WEAK		= 0x2,
+		STB_GNU_UNIQUE	= 0xA
+	};
+
+	static uint8_t *get_symbol_binding_name(SymbolBindings binding)
+	{
+		switch(binding)
+		{
+			case SymbolBindings::STB_LOCAL: return (uint8_t *) "Local";break;
+			case SymbolBindings::STB_GLOBAL: return (uint8_t *) "Global";break;
+			case SymbolBindings::STB_WEAK: return (uint8_t *) "Weak";break;
+			case SymbolBindings::STB_GNU_UNIQUE: return (uint8_t *) "GNU Unique";break;
+			default: break;
+		}
+
+		return (uint8_t *) "Unknown Symbol Binding";
+	}
+
+	enum class SymbolVisibilities: uint8_t
+	{
+		STV_DEFAULT		= 0x0,
+		STV_INTERNAL	= 0x1,
+		STV_HIDDEN		= 0x2,
+		STV_PROTECTED	= 0x3
+	};
+
+	static uint8_t *get_symbol_visibility_name(SymbolVisibilities visibility)
+	{
+		switch(visibility)
+		{
+			case SymbolVisibilities::STV_DEFAULT: return (uint8_t *) "Default";break;
+			case SymbolVisibilities::STV_INTERNAL: return (uint8_t *) "Internal";break;
+			case SymbolVisibilities::STV_HIDDEN: return (uint8_t *) "Hidden";break;
+			case SymbolVisibilities::STV_PROTECTED: return (uint8_t *) "Protected";break;
+			default: break;
+		}
+
+		return (uint8_t *) "Unknown Symbol Visibility";
+	}
+
+	/* A symbol table section (`.symtab` or `.dynsym`), decoded the first time it is asked for.
+	 *
+	 * Symbol names are kept as offsets into the table's string table (its `sh_link`) and are
+	 * only turned into `std::string_view`s, pointing into the file, when asked for.
+	 * Looking symbols up by name goes through a hash index that is built on the first lookup:
+	 * open addressing with linear probing over a power-of-two amount of slots, at most half full.
+	 * */
+	class ElfSymbolTable
+	{
+	public:
+		/* Ordered like a 64-bit symbol in the file, so for 64-bit files in the host's byte order the
+		 * table in the file is used as-is instead of being decoded.
+		 * */
+		struct Symbol
+		{
+			uint32_t		st_name;			/* offset of the name in the string table */
+			uint8_t			st_info;			/* type and binding */
+			uint8_t			st_other;			/* visibility */
+			uint16_t		st_section_index;
+			uint64_t		st_value;
+			uint64_t		st_size;
+
+			Symbol() = default;
+			~Symbol() = default;
+		};
+		static_assert(sizeof(struct Symbol) == sizeof(struct ELF64_raw_symbol)
+			&& offsetof(struct Symbol, st_section_index) == offsetof(struct ELF64_raw_symbol, st_shndx)
+			&& offsetof(struct Symbol, st_size) == offsetof(struct ELF64_raw_symbol, st_size));
+
+	protected:
+		ElfSection &elf_sections;
+		uint32_t table_index;			/* once the table is decoded */
+		SectionTypes table_type;
+
+		/* `symbol_amnt` contiguous entries, either pointing into the file or decoded into the file's arena. */
+		const struct Symbol *symbols;
+		uint32_t symbol_amnt;
+		bool symbols_decoded;
+		ElfStatus symbols_status;
+		ElfStringTable symbol_names;
+
+		/* The name index; a slot holds a symbol index + 1 (0 is an empty slot) and the hash of its name. */
+		uint32_t *index_symbols;
+		uint32_t *index_hashes;
+		uint32_t index_mask;
+		bool index_built;
+
+		template<typename Traits>
+		ElfStatus decode_symbol_table();
+
+	public:
+		/* The first section of type `type` (`SHT_SYMTAB` or `SHT_DYNSYM`); nothing is decoded yet. */
+		ElfSymbolTable(ElfSection &sections, SectionTypes type = SectionTypes::SHT_SYMTAB);
+
+		/* Start over on whatever file `sections` decodes now. */
+		void reset();
+
+		/* FNV-1a; cheap, and good enough to spread symbol names over the slots. */
+		static uint32_t hash_name(std::string_view name)
+		{
+			uint32_t hash = 0x811C9DC5;
+
+			for(char c : name)
+				hash = (hash ^ (uint8_t) c) * 0x01000193;
+
+			return hash;
+		}
+
+		/* Whether the binary has a table of this type at all; decodes it to find out. */
+		bool is_present() { get_symbol_table(); return table_index < elf_sections.get_section_amnt(); }
+
+		ElfStatus get_symbol_table();
+		void build_name_index();
+
+		uint32_t get_symbol_amnt() { get_symbol_table(); return symbol_amnt; }
+		const struct Symbol &get_symbol(uint32_t index) { return symbols[index]; }
+		std::string_view get_symbol_name(uint32_t index) { return symbol_names.get_string(symbols[index].st_name); }
+		std::string_view get_table_name() { return elf_sections.get_section_name(table_index); }
+
+		/* Index of the first symbol named `name`, or `get_symbol_amnt()` if there is none. */
+		uint32_t find_symbol(std::string_view name);
+
+		void print_symbol_table(ElfOutput &out);
+		/* `"symtab":[...]` or `"dynsym":[...]`, for the JSON output formats. */
+		void print_symbol_table_json(ElfOutput &out);
+
+		template<typename T>
+			requires std::is_same<T, ElfSymbolTable *>::value
+		void delete_instance(T instance)
+		{
+			if(instance)
+				delete instance;
+			instance = nullptr;
+		}
+
+		/* The table and the name index go with the decoder's arena. */
+		~ElfSymbolTable() = default;
+	};
+}
+
+#endif
@@ -1,41 +1,670 @@
 #include "include/elf_decoder.hpp"
+#include "include/elf_batch.hpp"
+#include "include/elf_scan.hpp"
+#include "include/elf_async.hpp"
+#include "include/elf_symbols.hpp"
+#include "include/elf_hash.hpp"
+#include "include/elf_relocations.hpp"
+#include "include/elf_dependencies.hpp"
+#include "include/elf_cache.hpp"
+#include "include/elf_build_id.hpp"
+#include "include/elf_context.hpp"
+#include <atomic>
+#include <fcntl.h>
 #include <vector>
 //using namespace elf_header;
+using namespace elf_batch;
+using namespace elf_scan;
+using namespace elf_async;
+using namespace elf_symbols;
+using namespace elf_hash;
+using namespace elf_relocations;
+using namespace elf_dependencies;
+using namespace elf_cache;
+using namespace elf_build_id;
+using namespace elf_context;
+
+/* What goes into each file's report. */
+struct report_options
+{
+	ElfOutputFormats	format;
+	bool				symbols;		/* `.symtab` and `.dynsym` */
+	bool				relocations;	/* relocation counts */
+	bool				relocation_list;	/* every relocation, too */
+	bool				dynamic;		/* the dynamic section */
+	bool				notes;			/* the notes */
+	bool				dependencies;	/* only resolve the needed libraries */
+	bool				summary;		/* only a summary of each file */
+	ElfDecodeCache		*cache;			/* summaries from earlier runs, if any */
+	const std::vector<uint64_t>	*cache_records;	/* with -r, where the scan found each file in the cache (`ELF_CACHE_NO_RECORD` if it did not) */
+	ElfBuildIdIndex		*build_id_index;	/* only gather build IDs into this */
+	const char			*symbol_name;	/* only look this symbol up */
+	const char			*export_name;	/* only check whether this symbol is exported */
+};
+
+/* Files that could not be decoded, for the exit status. */
+static std::atomic<uint32_t> failed_files(0);
+
+/* Every file a thread decodes goes through the same context, so what got allocated for one file is reused for the next. */
+static ElfDecodeContext &get_decode_context()
+{
+	static thread_local ElfDecodeContext context;
+	return context;
+}
+
+/* Start the `index`th record of the JSON output formats; every record but the first of
+ * `ElfOutputFormats::Json` starts with a comma, as they are the elements of one array
+ * (opened and closed in `main`).
+ * */
+static void start_json_record(const char *filename, uint32_t index, ElfOutputFormats format, ElfOutput &out)
+{
+	if(format == ElfOutputFormats::Json && index > 0)
+		out.character(',');
+
+	out.character('{').json_key("file").json_string(filename);
+}
+
+/* Say why `filename` could not be decoded, and move on to the next file.
+ * In the JSON output formats the file still gets a record, so every file given shows up in the output.
+ * */
+static void report_error(const char *filename, uint32_t index, ELF_errors error, const struct report_options &options, ElfOutput &out)
+{
+	const char *error_name = (const char *) get_ELF_error_name(error);
+
+	failed_files++;
+	fprintf(stderr, "%s: %s\n", filename, error_name);
+
+	if(options.format == ElfOutputFormats::Text || options.build_id_index)
+		return;
+
+	start_json_record(filename, index, options.format, out);
+	out.character(',').json_key("error").json_string(error_name).text("}\n");
+}
+
+/* Look `name` up in `.symtab`, then in `.dynsym`. */
+static ElfStatus print_symbol_lookup(ElfDecodeContext &context, const char *filename, uint32_t index, const char *name, ElfOutputFormats format, ElfOutput &out)
+{
+	ElfSymbolTable &symbol_table = context.get_symbol_table(SectionTypes::SHT_SYMTAB);
+	ElfSymbolTable &dynamic_symbol_table = context.get_symbol_table(SectionTypes::SHT_DYNSYM);
+	ElfSymbolTable *found_in = nullptr;
+	uint32_t found = 0;
+
+	/* `.dynsym` is only decoded if the symbol is not in `.symtab`. */
+	ELF_TRY(symbol_table.get_symbol_table())
+	if((found = symbol_table.find_symbol(name)) < symbol_table.get_symbol_amnt())
+		found_in = &symbol_table;
+	else
+	{
+		ELF_TRY(dynamic_symbol_table.get_symbol_table())
+		if((found = dynamic_symbol_table.find_symbol(name)) < dynamic_symbol_table.get_symbol_amnt())
+			found_in = &dynamic_symbol_table;
+	}
+
+	if(format != ElfOutputFormats::Text)
+	{
+		start_json_record(filename, index, format, out);
+		out.character(',').json_key("symbol").json_string(name).character(',').json_key("found").text(found_in ? "true" : "false");
+		if(found_in)
+		{
+			out.character(',').json_key("table").json_string(found_in->get_table_name()).character(',')
+				.json_key("value").decimal(found_in->get_symbol(found).st_value).character(',')
+				.json_key("size").decimal(found_in->get_symbol(found).st_size);
+		}
+		out.text("}\n");
+		return ElfStatus();
+	}
+
+	out.text(filename).text(": ").description(name);
+	if(!found_in)
+	{
+		out.text(" not found\n");
+		return ElfStatus();
+	}
+
+	out.text(" found in ").description(found_in->get_table_name()).text(" (Symbol #").decimal(found)
+		.text(", Value: ").value_hex(found_in->get_symbol(found).st_value)
+		.text(", Size: ").color(ELF_COLOR_VALUE).decimal(found_in->get_symbol(found).st_size).color(ELF_COLOR_RESET).text(")\n");
+	return ElfStatus();
+}
+
+/* Check whether the file exports `name`, through its own hash table; binaries without one
+ * (static executables, relocatable files...) fall back to searching `.dynsym`.
+ * */
+static ElfStatus print_export_check(ElfDecodeContext &context, const char *filename, uint32_t index, const char *name, ElfOutputFormats format, ElfOutput &out)
+{
+	ElfHashTable hash_table(context.get_sections());
+	struct ElfSymbolTable::Symbol symbol;
+	uint32_t found = ELF_HASH_NOT_FOUND;
+
+	ELF_TRY(hash_table.load_table())
+	if(hash_table.is_present())
+		found = hash_table.find_symbol(name, symbol);
+	else
+	{
+		ElfSymbolTable &dynamic_symbol_table = context.get_symbol_table(SectionTypes::SHT_DYNSYM);
+
+		ELF_TRY(dynamic_symbol_table.get_symbol_table())
+		found = dynamic_symbol_table.find_symbol(name);
+		if(found < dynamic_symbol_table.get_symbol_amnt())
+			symbol = dynamic_symbol_table.get_symbol(found);
+		else
+			found = ELF_HASH_NOT_FOUND;
+	}
+
+	bool exported = found != ELF_HASH_NOT_FOUND && ElfHashTable::is_exported(symbol);
+
+	if(format != ElfOutputFormats::Text)
+	{
+		start_json_record(filename, index, format, out);
+		out.character(',').json_key("symbol").json_string(name).character(',').json_key("exported").text(exported ? "true" : "false");
+		if(exported)
+			out.character(',').json_key("value").decimal(symbol.st_value).character(',').json_key("size").decimal(symbol.st_size);
+		out.text("}\n");
+		return ElfStatus();
+	}
+
+	out.text(filename).text(": ").description(name);
+	if(!exported)
+	{
+		out.text(" not exported\n");
+		return ElfStatus();
+	}
+
+	out.text(" exported (Symbol #").decimal(found)
+		.text(", Value: ").value_hex(symbol.st_value)
+		.text(", Size: ").color(ELF_COLOR_VALUE).decimal(symbol.st_size).color(ELF_COLOR_RESET).text(")\n");
+	return ElfStatus();
+}
+
+/* Print everything about the `index`th file to `out`.
+ * Everything the report needs is decoded before anything gets printed, so a file that turns
+ * out to be broken leaves no half of a report behind.
+ * */
+static ElfStatus print_report(ElfDecodeContext &context, const char *filename, uint32_t index, const struct report_options &options, ElfOutput &out)
+{
+	if(options.symbol_name)
+		return print_symbol_lookup(context, filename, index, options.symbol_name, options.format, out);
+	if(options.export_name)
+		return print_export_check(context, filename, index, options.export_name, options.format, out);
+
+	ElfSection *elf_sections = &context.get_sections();
+
+	ELF_TRY(elf_sections->get_program_header_table())
+	ELF_TRY(elf_sections->get_section_header_table())
+
+	/* None of these decode anything yet. */
+	ElfSymbolTable &symbol_table = context.get_symbol_table(SectionTypes::SHT_SYMTAB);
+	ElfSymbolTable &dynamic_symbol_table = context.get_symbol_table(SectionTypes::SHT_DYNSYM);
+	ElfDynamic &dynamic = context.get_dynamic();
+	ElfNotes &notes = context.get_notes();
+	ElfRelocations &relocations = context.get_relocations();
+
+	if(options.symbols)
+	{
+		ELF_TRY(symbol_table.get_symbol_table())
+		ELF_TRY(dynamic_symbol_table.get_symbol_table())
+	}
+	if(options.dynamic)
+		ELF_TRY(dynamic.get_dynamic_section())
+	if(options.notes)
+		ELF_TRY(notes.get_notes())
+	/* The relocations are decoded as they get printed; this only checks where they are. */
+	if(options.relocations)
+		ELF_TRY(relocations.validate())
+
+	if(options.format == ElfOutputFormats::Text)
+	{
+		elf_sections->print_elf_header(out);
+		elf_sections->print_elf_program_header_table(out);
+		elf_sections->print_elf_section_header_table(out);
+
+		if(options.symbols)
+		{
+			symbol_table.print_symbol_table(out);
+			dynamic_symbol_table.print_symbol_table(out);
+		}
+		if(options.dynamic)
+			dynamic.print_dynamic_section(out);
+		if(options.notes)
+			notes.print_notes(out);
+		if(options.relocations)
+		{
+			if(options.relocation_list)
+				relocations.print_relocation_list(out);
+			relocations.print_relocation_summary(out);
+		}
+		return ElfStatus();
+	}
+
+	start_json_record(filename, index, options.format, out);
+
+	out.character(',');
+	elf_sections->print_elf_header_json(out);
+	out.character(',');
+	elf_sections->print_elf_program_header_table_json(out);
+	out.character(',');
+	elf_sections->print_elf_section_header_table_json(out);
+
+	if(options.symbols)
+	{
+		out.character(',').json_key("symbols").character('{');
+		symbol_table.print_symbol_table_json(out);
+		out.character(',');
+		dynamic_symbol_table.print_symbol_table_json(out);
+		out.character('}');
+	}
+
+	if(options.dynamic)
+	{
+		out.character(',');
+		dynamic.print_dynamic_section_json(out);
+	}
+	if(options.notes)
+	{
+		out.character(',');
+		notes.print_notes_json(out);
+	}
+	if(options.relocations)
+	{
+		if(options.relocation_list)
+		{
+			out.character(',');
+			relocations.print_relocation_list_json(out);
+		}
+		out.character(',');
+		relocations.print_relocation_summary_json(out);
+	}
+
+	out.text("}\n");
+	return ElfStatus();
+}
+
+/* Whether the cache has `filename`; files the scan found were already looked up while scanning. */
+static bool lookup_summary(const char *filename, uint32_t index, const struct report_options &options, struct ElfSummaryView &view)
+{
+	if(!options.cache)
+		return false;
+
+	if(!options.cache_records)
+		return options.cache->lookup(AT_FDCWD, filename, view);
+
+	uint64_t record = (*options.cache_records)[index];
+	if(record == ELF_CACHE_NO_RECORD)
+		return false;
+
+	options.cache->get_summary(record, view);
+	return true;
+}
+
+/* Print the summary of `filename`; it is only opened if the cache does not have it. */
+static void decode_summary(const char *filename, uint32_t index, const struct report_options &options, ElfOutput &out)
+{
+	struct ElfSummaryView view;
+	int elf_fd = -1;
+
+	if(!lookup_summary(filename, index, options, view))
+	{
+		struct stat file_stats = {};
+		bool cacheable = false;
+
+		elf_fd = open(filename, O_RDONLY | O_CLOEXEC);
+
+		ElfDecodeContext &context = get_decode_context();
+		ElfStatus status = context.reset(elf_fd, *(int8_t *)filename, ELF_load_modes::Lazy);
+
+		/* The key is the file as it was opened, so a change made since cannot sneak in under it.
+		 * If the file cannot be stat'ed, it is still summarized, just not cached.
+		 * */
+		if(status)
+		{
+			cacheable = fstat(elf_fd, &file_stats) == 0;
+			status = ElfDecodeCache::summarize(context.get_sections(), context.get_notes(), ElfDecodeCache::make_key(file_stats), view);
+		}
+
+		if(!status)
+		{
+			report_error(filename, index, status.error(), options, out);
+			if(elf_fd >= 0)
+				close(elf_fd);
+			return;
+		}
+
+		if(options.cache && cacheable)
+			options.cache->insert(view);
+	}
+
+	if(options.build_id_index)
+	{
+		if(view.summary.build_id_size > 0)
+			options.build_id_index->add(view.summary.build_id, view.summary.build_id_size, filename);
+	}
+	else if(options.format == ElfOutputFormats::Text)
+		ElfDecodeCache::print_summary(view, filename, out);
+	else
+	{
+		start_json_record(filename, index, options.format, out);
+		out.character(',');
+		ElfDecodeCache::print_summary_json(view, out);
+		out.text("}\n");
+	}
+
+	if(elf_fd >= 0)
+		close(elf_fd);
+}
+
+/* Decode `filename` and print everything about it to `out`. */
+static void decode_file(const char *filename, uint32_t index, ELF_load_modes load_mode, const struct report_options &options, ElfOutput &out)
+{
+	if(options.summary)
+	{
+		decode_summary(filename, index, options, out);
+		return;
+	}
+
+	int elf_fd = open(filename, O_RDONLY | O_CLOEXEC);
+
+	ElfDecodeContext &context = get_decode_context();
+	ElfStatus status = context.reset(elf_fd, *(int8_t *)filename, load_mode);
+
+	if(status)
+		status = print_report(context, filename, index, options, out);
+
+	if(!status)
+		report_error(filename, index, status.error(), options, out);
+
+	if(elf_fd >= 0)
+		close(elf_fd);
+}
+
+/* Decode a file whose header and tables were already read in by the async reader. */
+static void decode_prefetched_file(const char *filename, uint32_t index, struct ElfPrefetchedFile &prefetched, const struct report_options &options, ElfOutput &out)
+{
+	/* Anything the reader could not (or would not) open is decoded the usual way. */
+	if(prefetched.fd < 0)
+	{
+		decode_file(filename, index, ELF_load_modes::Lazy, options, out);
+		return;
+	}
+
+	int elf_fd = prefetched.fd;
+	prefetched.fd = -1;
+
+	ElfDecodeContext &context = get_decode_context();
+	ElfStatus status = context.reset(elf_fd, *(int8_t *)filename, ELF_load_modes::Lazy);
+	context.get_sections().get_decoder()->ELF_adopt_ranges(prefetched.ranges);
+
+	if(status)
+		status = print_report(context, filename, index, options, out);
+
+	if(!status)
+		report_error(filename, index, status.error(), options, out);
+
+	close(elf_fd);
+}
+
+/* Resolve the libraries each of `files` needs, decoding every file involved once, and print them. */
+static void print_dependency_graph(const std::vector<const char *> &files, const struct report_options &options, bool colors)
+{
+	ElfDependencyGraph graph;
+	ElfOutput out(colors);
+
+	for(uint32_t i = 0; i < files.size(); i++)
+	{
+		uint32_t node = graph.add_file(files[i]);
+
+		/* Only the files asked about are errors; libraries that cannot be decoded are just not found. */
+		ElfStatus status = graph.get_status(node);
+		if(!status)
+		{
+			report_error(files[i], i, status.error(), options, out);
+			continue;
+		}
+
+		graph.resolve(node);
+
+		if(options.format == ElfOutputFormats::Text)
+			graph.print_dependencies(node, files[i], out);
+		else
+		{
+			if(options.format == ElfOutputFormats::Json && i > 0)
+				out.character(',');
+
+			out.character('{').json_key("file").json_string(files[i]).character(',');
+			graph.print_dependencies_json(node, out);
+			out.text("}\n");
+		}
+
+		if(out.get_size() >= ELF_OUTPUT_INITIAL_SIZE)
+			out.flush(STDOUT_FILENO);
+	}
+
+	out.flush(STDOUT_FILENO);
+}
+
+/* Print the file that has the build ID spelled out by `hex`, from the index at `index_path`. */
+static int print_build_id_lookup(const char *hex, const char *index_path)
+{
+	uint8_t build_id[ELF_BUILD_ID_MAX_SIZE];
+	uint32_t build_id_size = ElfBuildIdIndex::parse_build_id(hex, build_id);
+	std::string path;
+
+	ELF_ASSERT(build_id_size > 0,
+		"\n`%s` is not a build ID.\n", hex)
+
+	if(!ElfBuildIdIndex::lookup(index_path, build_id, build_id_size, path))
+	{
+		fprintf(stderr, "%s: not found\n", hex);
+		return EXIT_FAILURE;
+	}
+
+	printf("%s\n", path.c_str());
+	return 0;
+}
 
 int main(int args, char *argv[])
 {
 	ELF_ASSERT(args > 1,
 		"\nExpected ELF binary file as an argument.\n")
-	
-	FILE *elf_file = nullptr;
-	ElfProgramHeader *pheader = nullptr;
 
-	if(strcmp(argv[1], "-f") == 0)
+	ELF_load_modes load_mode = ELF_load_modes::Mapped;
+	bool multiple_files = false;
+	bool scan_directories = false;
+	bool async_reads = false;
+	bool use_io_uring = true;
+	bool colors = ElfOutput::should_use_colors(STDOUT_FILENO);
+	struct report_options options = { ElfOutputFormats::Text, false, false, false, false, false, false, false, nullptr, nullptr, nullptr, nullptr, nullptr };
+	const char *build_id_index_path = nullptr;
+	uint32_t workers = 0;
+	int i = 1;
+
+	/* Options come before the ELF binary file(s).
+	 *
+	 * -l:   lazy mode; only the header and the tables that get decoded are read in.
+	 * -j N: decode with N worker threads (default: one per core).
+	 * -f:   decode every file that follows.
+	 * -r:   decode every ELF binary file found under the directories that follow.
+	 * -a:   with -f/-r, read the files in ahead of the decoders with io_uring (if the kernel has it).
+	 * -A:   like -a, but always with a pool of threads doing `pread`s.
+	 * --no-color: plain text output (the default when not writing to a terminal).
+	 * --color:    colored output, even when not writing to a terminal.
+	 * --format=text|json|ndjson: how each file's report looks (see `ElfOutputFormats`).
+	 * -s:   also print the symbol tables.
+	 * -R:   also print how many relocations there are, of each type.
+	 * --list-relocations: like -R, and print every relocation as well.
+	 * -d:   also print the dynamic section.
+	 * -n:   also print the notes (build ID, ABI tag, program properties...).
+	 * -D:   only print the libraries each file needs and where they are found (like `ldd`).
+	 * --summary:      only print a summary of each file (header, segments, sections and build ID).
+	 * --cache=FILE:   like --summary, keeping the summaries in FILE between runs; files that have not
+	 *                 changed since (same device, inode, size and mtime) are not opened again.
+	 *                 -a/-A are ignored with either, since reading ahead would open every file.
+	 * --build-id-index=FILE: like --summary, but instead of printing anything write the build ID of
+	 *                 every file to FILE, sorted so it can be searched (combines with --cache).
+	 * --find-build-id=HEX: print the file with build ID HEX, from the index that follows.
+	 * -y S: only look up the symbol named S in each file.
+	 * -x S: only check whether each file exports the symbol named S (through its hash table).
+	 * */
+	while(i < args && argv[i][0] == '-')
+	{
+		if(strcmp(argv[i], "-l") == 0)
+			load_mode = ELF_load_modes::Lazy;
+		else if(strcmp(argv[i], "-f") == 0)
+			multiple_files = true;
+		else if(strcmp(argv[i], "-r") == 0)
+			scan_directories = true;
+		else if(strcmp(argv[i], "-a") == 0)
+			async_reads = true;
+		else if(strcmp(argv[i], "-A") == 0)
+		{
+			async_reads = true;
+			use_io_uring = false;
+		}
+		else if(strcmp(argv[i], "--no-color") == 0)
+			colors = false;
+		else if(strcmp(argv[i], "--color") == 0)
+			colors = true;
+		else if(strcmp(argv[i], "--format=text") == 0)
+			options.format = ElfOutputFormats::Text;
+		else if(strcmp(argv[i], "--format=json") == 0)
+			options.format = ElfOutputFormats::Json;
+		else if(strcmp(argv[i], "--format=ndjson") == 0)
+			options.format = ElfOutputFormats::Ndjson;
+		else if(strcmp(argv[i], "-s") == 0)
+			options.symbols = true;
+		else if(strcmp(argv[i], "-R") == 0)
+			options.relocations = true;
+		else if(strcmp(argv[i], "--list-relocations") == 0)
+			options.relocations = options.relocation_list = true;
+		else if(strcmp(argv[i], "-d") == 0)
+			options.dynamic = true;
+		else if(strcmp(argv[i], "-n") == 0)
+			options.notes = true;
+		else if(strcmp(argv[i], "-D") == 0)
+			options.dependencies = true;
+		else if(strcmp(argv[i], "--summary") == 0)
+			options.summary = true;
+		else if(strncmp(argv[i], "--cache=", 8) == 0)
+		{
+			options.summary = true;
+			options.cache = new ElfDecodeCache(argv[i] + 8);
+		}
+		else if(strncmp(argv[i], "--build-id-index=", 17) == 0)
+		{
+			options.summary = true;
+			options.build_id_index = new ElfBuildIdIndex();
+			build_id_index_path = argv[i] + 17;
+		}
+		else if(strncmp(argv[i], "--find-build-id=", 16) == 0 && i + 1 < args)
+			return print_build_id_lookup(argv[i] + 16, argv[i + 1]);
+		else if(strcmp(argv[i], "-y") == 0 && i + 1 < args)
+			options.symbol_name = argv[++i];
+		else if(strcmp(argv[i], "-x") == 0 && i + 1 < args)
+			options.export_name = argv[++i];
+		else if(strcmp(argv[i], "-j") == 0 && i + 1 < args)
+			workers = atoi(argv[++i]);
+		else
+			ELF_LOG(true, "\nUnknown option `%s`.\n", argv[i])
+
+		i++;
+	}
+
+	ELF_ASSERT(i < args,
+		"\nExpected ELF binary file as an argument.\n")
+
+	if(options.format == ElfOutputFormats::Json)
+		ElfOutput::write_all(STDOUT_FILENO, "[", 1);
+
+	if(multiple_files || scan_directories)
 	{
-		uint32_t i = 2;
-		while(i < args)
+		std::vector<const char *> files;
+		std::vector<struct ElfScannedFile> found;
+		std::vector<uint64_t> cache_records;
+
+		if(scan_directories)
 		{
-			elf_file = fopen(argv[i], "rb");
+			ElfDirectoryScan scan(workers);
 
-			/* Decode. */
-			pheader = new ElfProgramHeader(elf_file, *(int8_t *)argv[i]);
-			pheader->get_program_header_table();
+			/* Whatever is in the cache does not need its magic number read again, nor to be looked up again
+			 * (with another `stat`) when its summary is printed.
+			 * */
+			if(options.cache)
+			{
+				scan.set_known_files([&options] (int directory_fd, const char *name, uint64_t &tag) {
+					return options.cache->contains(directory_fd, name, tag);
+				});
+				options.cache_records = &cache_records;
+			}
 
-			fclose(elf_file);
-			delete pheader;
-			i++;
+			for(; i < args; i++)
+				scan.scan(argv[i], found);
+			for(auto &file : found)
+			{
+				files.push_back(file.path.c_str());
+				cache_records.push_back(file.tag == ELF_SCAN_NO_TAG ? ELF_CACHE_NO_RECORD : file.tag);
+			}
 		}
+		else
+			files.assign(&argv[i], &argv[args]);
+
+		if(options.dependencies)
+		{
+			print_dependency_graph(files, options, colors);
+			goto end;
+		}
+
+		ElfBatch batch(workers, colors);
+
+		if(async_reads && !options.summary)
+		{
+			ElfAsyncReader reader(use_io_uring);
+			reader.start(files, batch.get_window());
+
+			batch.run(files, [&reader, &options] (uint32_t index, const char *filename, ElfOutput &out) {
+				decode_prefetched_file(filename, index, reader.wait_for(index), options, out);
+				reader.release(index);
+			});
+
+			goto end;
+		}
+
+		batch.run(files, [load_mode, &options] (uint32_t index, const char *filename, ElfOutput &out) {
+			decode_file(filename, index, load_mode, options, out);
+		});
 
 		goto end;
 	}
 
-	elf_file = fopen(argv[1], "rb");
-	
-	pheader = new ElfProgramHeader(elf_file, *(int8_t *)argv[1]);
-	pheader->get_program_header_table();
+	if(options.dependencies)
+	{
+		print_dependency_graph({ argv[i] }, options, colors);
+		goto end;
+	}
+
+	{
+		ElfOutput out(colors);
 
-	//delete pheader;
+		decode_file(argv[i], 0, load_mode, options, out);
+		out.flush(STDOUT_FILENO);
+	}
 
 	end:
-	return 0;
+	if(options.format == ElfOutputFormats::Json)
+		ElfOutput::write_all(STDOUT_FILENO, "]\n", 2);
+
+	/* Not being able to save the cache is an error too, though everything was printed. */
+	if(options.cache)
+	{
+		if(!options.cache->save())
+			failed_files++;
+		delete options.cache;
+	}
+	if(options.build_id_index)
+	{
+		ELF_ASSERT(options.build_id_index->write(build_id_index_path),
+			"\nCould not write the build ID index to `%s`.\n", build_id_index_path)
+		delete options.build_id_index;
+	}
+
+	/* Every file that could be decoded was; the status says whether any could not. */
+	return failed_files > 0 ? EXIT_FAILURE : 0;
 }
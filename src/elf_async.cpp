@@ -0,0 +1,508 @@
+#include <elf_async.hpp>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <sched.h>
+using namespace elf_async;
+
+ElfAsyncReader::ElfAsyncReader(bool use_io_uring, uint32_t depth)
+    : backend(ElfAsyncBackends::ThreadPool), ring{}, queue_depth(depth), file_limit(depth * ELF_ASYNC_FILES_PER_READ),
+      files(nullptr), released(0), stopping(false), next_file(0)
+{
+    ring.fd = -1;
+
+    /* Every file has at most 2 reads in flight. */
+    if(queue_depth < 2)
+        queue_depth = 2;
+
+    if(use_io_uring && setup_ring())
+        backend = ElfAsyncBackends::IoUring;
+}
+
+/* Set up the rings by hand; this fails on kernels without io_uring (`ENOSYS`) or where it is blocked (`EPERM`). */
+bool ElfAsyncReader::setup_ring()
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = syscall(__NR_io_uring_setup, queue_depth, &params);
+    if(fd < 0)
+        return false;
+
+    ring.fd = fd;
+    ring.entries = params.sq_entries;
+    ring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    /* Newer kernels map both rings with one `mmap`. */
+    if(params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if(ring.cq_ring_size > ring.sq_ring_size)
+            ring.sq_ring_size = ring.cq_ring_size;
+        ring.cq_ring_size = ring.sq_ring_size;
+    }
+
+    ring.sq_ring = mmap(nullptr, ring.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring.cq_ring = ring.sq_ring;
+    if(ring.sq_ring != MAP_FAILED && !(params.features & IORING_FEAT_SINGLE_MMAP))
+        ring.cq_ring = mmap(nullptr, ring.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    ring.sqes = (struct io_uring_sqe *) mmap(nullptr, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if(ring.sq_ring == MAP_FAILED || ring.cq_ring == MAP_FAILED || ring.sqes == MAP_FAILED)
+    {
+        destroy_ring();
+        return false;
+    }
+
+    uint8_t *sq = (uint8_t *) ring.sq_ring;
+    uint8_t *cq = (uint8_t *) ring.cq_ring;
+
+    ring.sq_head = (uint32_t *) (sq + params.sq_off.head);
+    ring.sq_tail = (uint32_t *) (sq + params.sq_off.tail);
+    ring.sq_mask = (uint32_t *) (sq + params.sq_off.ring_mask);
+    ring.sq_array = (uint32_t *) (sq + params.sq_off.array);
+    ring.cq_head = (uint32_t *) (cq + params.cq_off.head);
+    ring.cq_tail = (uint32_t *) (cq + params.cq_off.tail);
+    ring.cq_mask = (uint32_t *) (cq + params.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+    /* The kernel may round the ring size up; never keep more reads in flight than there are entries. */
+    if(queue_depth > ring.entries)
+        queue_depth = ring.entries;
+
+    return true;
+}
+
+void ElfAsyncReader::destroy_ring()
+{
+    if(ring.sqes && ring.sqes != MAP_FAILED)
+        munmap(ring.sqes, ring.sqes_size);
+    if(ring.cq_ring && ring.cq_ring != MAP_FAILED && ring.cq_ring != ring.sq_ring)
+        munmap(ring.cq_ring, ring.cq_ring_size);
+    if(ring.sq_ring && ring.sq_ring != MAP_FAILED)
+        munmap(ring.sq_ring, ring.sq_ring_size);
+    if(ring.fd >= 0)
+        close(ring.fd);
+
+    ring = {};
+    ring.fd = -1;
+}
+
+/* Only regular files get read in here; anything else (FIFOs etc.) is left to the decoder, which
+ * already knows how to deal with it. `O_NONBLOCK` keeps the open itself from waiting on a FIFO.
+ * */
+void ElfAsyncReader::open_file(uint32_t index)
+{
+    struct ElfPrefetchedFile &prefetched = states[index].prefetched;
+    struct stat file_stats;
+
+    prefetched.fd = open((*files)[index], O_RDONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+    prefetched.size = 0;
+
+    if(prefetched.fd < 0)
+        return;
+
+    if(fstat(prefetched.fd, &file_stats) != 0 || !S_ISREG(file_stats.st_mode))
+    {
+        close(prefetched.fd);
+        prefetched.fd = -1;
+        return;
+    }
+
+    prefetched.size = file_stats.st_size;
+}
+
+/* Decide what to read in the file's next round, and add a buffer for each read to the file's ranges.
+ * Returns how many reads there are; 0 once the file has been read in as far as it can be.
+ * */
+uint32_t ElfAsyncReader::plan_reads(uint32_t index)
+{
+    struct file_state &state = states[index];
+    std::vector<struct ElfDecoder::ELF_range> &ranges = state.prefetched.ranges;
+    size_t offsets[2];
+    size_t lengths[2];
+    uint32_t amnt = 0;
+
+    if(state.prefetched.fd < 0)
+        return 0;
+
+    state.round++;
+
+    if(state.round == 1)
+    {
+        offsets[amnt] = 0;
+        lengths[amnt++] = ELF_MAX_HEADER_SIZE;
+    }
+    else if(state.round <= 3)
+    {
+        /* Anything wrong with the header is left for the decoder to report. */
+        const std::vector<uint8_t> &raw = ranges[0].data;
+        if(raw.size() < ELF_IDENT_SIZE || ELF_read_value<uint32_t, std::endian::big>(raw.data()) != ELF_MAGIC_NUMBER)
+            return 0;
+        if(raw[4] != ELF_CLASS_32 && raw[4] != ELF_CLASS_64)
+            return 0;
+
+        ELF_dispatch(raw[4], raw[5], [&] <typename Traits> () {
+            if(raw.size() < Traits::header_size)
+                return;
+
+            struct ElfHeader::ELF_header header;
+            ElfHeader::ELF_decode_header<Traits>(raw.data(), header);
+
+            /* A header the decoder would reject gets nothing read for it; with bogus entry sizes
+             * the tables could cover the whole file.
+             * */
+            if(!ElfHeader::ELF_validate_header(header))
+                return;
+
+            if(state.round == 2)
+            {
+                /* Extended numbering needs section 0 first; the decoder reads that itself. */
+                if(header.ELF_PH_offset != 0 && header.ELF_PH_entry_amnt != ELF_PH_EXTENDED_NUMBERING)
+                {
+                    offsets[amnt] = header.ELF_PH_offset;
+                    lengths[amnt++] = (size_t) header.ELF_PH_entry_amnt * header.ELF_PH_entry_size;
+                }
+                if(header.ELF_SH_offset != 0 && header.ELF_SH_entry_amnt != 0)
+                {
+                    offsets[amnt] = header.ELF_SH_offset;
+                    lengths[amnt++] = (size_t) header.ELF_SH_entry_amnt * header.ELF_SH_size;
+                }
+
+                return;
+            }
+
+            /* The section names live in the string table the section header table points at. */
+            size_t entry_offset = (size_t) header.ELF_SH_str_index * header.ELF_SH_size;
+
+            if(header.ELF_SH_str_index == ELF_SH_UNDEFINED || header.ELF_SH_str_index == ELF_SH_EXTENDED_INDEX
+                || header.ELF_SH_size < Traits::section_header_size)
+                return;
+
+            for(auto &range : ranges)
+            {
+                if(range.offset != header.ELF_SH_offset || range.data.size() < entry_offset + Traits::section_header_size)
+                    continue;
+
+                const auto names = Traits::template overlay<typename Traits::SectionHeader>(range.data.data() + entry_offset);
+
+                offsets[amnt] = Traits::get(names.sh_offset);
+                lengths[amnt++] = Traits::get(names.sh_size);
+                break;
+            }
+        });
+    }
+
+    /* Clip everything to the file, the same way `ELF_load_range` does. */
+    uint32_t reads = 0;
+
+    for(uint32_t i = 0; i < amnt; i++)
+    {
+        if(offsets[i] >= state.prefetched.size || lengths[i] == 0)
+            continue;
+        if(lengths[i] > state.prefetched.size - offsets[i])
+            lengths[i] = state.prefetched.size - offsets[i];
+
+        ranges.push_back({ offsets[i], std::vector<uint8_t>(lengths[i]) });
+        reads++;
+    }
+
+    return reads;
+}
+
+void ElfAsyncReader::finish_file(uint32_t index)
+{
+    std::vector<struct ElfDecoder::ELF_range> &ranges = states[index].prefetched.ranges;
+
+    /* Drop whatever could not be read; the decoder will try again (and report the error). */
+    for(size_t i = 0; i < ranges.size();)
+    {
+        if(ranges[i].data.empty())
+            ranges.erase(ranges.begin() + i);
+        else
+            i++;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        states[index].ready = true;
+    }
+    file_ready.notify_all();
+}
+
+/* Keep at most `file_limit` files read in (or being read in) that have not been released yet. */
+bool ElfAsyncReader::wait_for_room(uint32_t index)
+{
+    std::unique_lock<std::mutex> guard(lock);
+    file_released.wait(guard, [this, index] () { return stopping || index < released + file_limit; });
+
+    return !stopping;
+}
+
+void ElfAsyncReader::run_ring()
+{
+    uint32_t amnt = files->size();
+    uint32_t next = 0;
+    uint32_t active_files = 0;
+    uint32_t in_flight = 0;
+    uint32_t to_submit = 0;
+    uint32_t sq_tail = *ring.sq_tail;
+
+    /* Queue the reads `plan_reads` just added; the `user_data` is the file and the range the read goes into. */
+    auto queue_reads = [&] (uint32_t index, uint32_t reads) {
+        struct file_state &state = states[index];
+        uint32_t first = state.prefetched.ranges.size() - reads;
+
+        for(uint32_t i = 0; i < reads; i++)
+        {
+            struct ElfDecoder::ELF_range &range = state.prefetched.ranges[first + i];
+            uint32_t slot = sq_tail & *ring.sq_mask;
+            struct io_uring_sqe *sqe = &ring.sqes[slot];
+
+            state.vectors[i] = { range.data.data(), range.data.size() };
+
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READV;
+            sqe->fd = state.prefetched.fd;
+            sqe->off = range.offset;
+            sqe->addr = (uint64_t) &state.vectors[i];
+            sqe->len = 1;
+            sqe->user_data = ((uint64_t) index << 8) | (first + i);
+
+            ring.sq_array[slot] = slot;
+            sq_tail++;
+        }
+
+        __atomic_store_n(ring.sq_tail, sq_tail, __ATOMIC_RELEASE);
+        state.reads_pending = reads;
+        in_flight += reads;
+        to_submit += reads;
+    };
+
+    /* Move a file on to its next round, or hand it over once it has been read in. */
+    auto advance = [&] (uint32_t index) {
+        uint32_t reads = plan_reads(index);
+
+        if(reads > 0)
+        {
+            queue_reads(index, reads);
+            return;
+        }
+
+        finish_file(index);
+        active_files--;
+    };
+
+    while(next < amnt || active_files > 0)
+    {
+        /* Start on new files while each of them can have both of its reads in flight.
+         * Only wait for the consumer to catch up when there is nothing else to wait for.
+         * */
+        while(next < amnt && (active_files + 1) * 2 <= queue_depth)
+        {
+            if(active_files > 0)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if(stopping || next >= released + file_limit)
+                    break;
+            }
+            else if(!wait_for_room(next))
+                break;
+
+            open_file(next);
+            active_files++;
+            advance(next++);
+        }
+
+        if(in_flight == 0)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if(stopping)
+                break;
+
+            continue;
+        }
+
+        int result = syscall(__NR_io_uring_enter, ring.fd, to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if(result < 0)
+        {
+            if(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+
+            /* The ring cannot be used any more (`ENOMEM`, or blocked halfway through); the rest is read with `pread`. */
+            abandon_ring(in_flight - to_submit, next);
+            return;
+        }
+        to_submit -= (uint32_t) result < to_submit ? (uint32_t) result : to_submit;
+
+        uint32_t cq_head = *ring.cq_head;
+        uint32_t cq_tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+
+        for(; cq_head != cq_tail; cq_head++)
+        {
+            struct io_uring_cqe *cqe = &ring.cqes[cq_head & *ring.cq_mask];
+            uint32_t index = cqe->user_data >> 8;
+            struct file_state &state = states[index];
+            struct ElfDecoder::ELF_range &range = state.prefetched.ranges[cqe->user_data & 0xFF];
+
+            /* Short (end of file) and failed reads just shrink the range. */
+            if(cqe->res < (int32_t) range.data.size())
+                range.data.resize(cqe->res > 0 ? cqe->res : 0);
+
+            in_flight--;
+            if(--state.reads_pending == 0)
+                advance(index);
+        }
+
+        __atomic_store_n(ring.cq_head, cq_head, __ATOMIC_RELEASE);
+    }
+}
+
+/* Wait for the `submitted` reads the kernel already has (their buffers must stay until then), drop the
+ * ring, and start the files before `next` that are not done over with the `pread` fallback.
+ * */
+void ElfAsyncReader::abandon_ring(uint32_t submitted, uint32_t next)
+{
+    uint32_t cq_head = *ring.cq_head;
+
+    while(submitted > 0)
+    {
+        uint32_t cq_tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+
+        if(cq_head == cq_tail)
+        {
+            if(syscall(__NR_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0)
+                sched_yield();
+            continue;
+        }
+
+        submitted -= cq_tail - cq_head;
+        cq_head = cq_tail;
+    }
+
+    __atomic_store_n(ring.cq_head, cq_head, __ATOMIC_RELEASE);
+    destroy_ring();
+    backend = ElfAsyncBackends::ThreadPool;
+
+    next_file = next;
+    for(uint32_t index = next; index-- > 0;)
+    {
+        struct file_state &state = states[index];
+
+        if(state.ready)
+            continue;
+
+        if(state.prefetched.fd >= 0)
+            close(state.prefetched.fd);
+        state.prefetched.fd = -1;
+        state.prefetched.ranges.clear();
+        state.round = 0;
+        state.reads_pending = 0;
+        next_file = index;
+    }
+
+    run_fallback();
+}
+
+void ElfAsyncReader::run_fallback()
+{
+    uint32_t amnt = files->size();
+
+    auto run_thread = [this, amnt] () {
+        uint32_t index;
+
+        while((index = next_file++) < amnt)
+        {
+            struct file_state &state = states[index];
+            uint32_t reads;
+
+            /* Read in by the ring before it was abandoned. */
+            if(state.ready)
+                continue;
+            if(!wait_for_room(index))
+                break;
+
+            open_file(index);
+
+            while((reads = plan_reads(index)) > 0)
+            {
+                for(size_t i = state.prefetched.ranges.size() - reads; i < state.prefetched.ranges.size(); i++)
+                {
+                    struct ElfDecoder::ELF_range &range = state.prefetched.ranges[i];
+                    ssize_t read_in = pread(state.prefetched.fd, range.data.data(), range.data.size(), range.offset);
+
+                    range.data.resize(read_in > 0 ? read_in : 0);
+                }
+            }
+
+            finish_file(index);
+        }
+    };
+
+    for(uint32_t i = 0; i < ELF_ASYNC_FALLBACK_THREADS; i++)
+        fallback_threads.emplace_back(run_thread);
+
+    for(auto &thread : fallback_threads)
+        thread.join();
+}
+
+void ElfAsyncReader::start(const std::vector<const char *> &file_list, uint32_t lookahead)
+{
+    files = &file_list;
+    if(file_limit < lookahead)
+        file_limit = lookahead;
+
+    states.assign(files->size(), {});
+    for(auto &state : states)
+        state.prefetched.fd = -1;
+
+    if(backend == ElfAsyncBackends::IoUring)
+        reader = std::thread(&ElfAsyncReader::run_ring, this);
+    else
+        reader = std::thread(&ElfAsyncReader::run_fallback, this);
+}
+
+struct ElfPrefetchedFile &ElfAsyncReader::wait_for(uint32_t index)
+{
+    std::unique_lock<std::mutex> guard(lock);
+    file_ready.wait(guard, [this, index] () { return states[index].ready; });
+
+    return states[index].prefetched;
+}
+
+void ElfAsyncReader::release(uint32_t index)
+{
+    struct ElfPrefetchedFile &prefetched = states[index].prefetched;
+
+    /* Whatever the caller did not take is let go of now, not once every file has been read. */
+    if(prefetched.fd >= 0)
+        close(prefetched.fd);
+    prefetched.fd = -1;
+    std::vector<struct ElfDecoder::ELF_range>().swap(prefetched.ranges);
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        released++;
+    }
+    file_released.notify_all();
+}
+
+ElfAsyncReader::~ElfAsyncReader()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    file_released.notify_all();
+
+    if(reader.joinable())
+        reader.join();
+
+    /* Files that were read in but never taken. */
+    for(auto &state : states)
+        if(state.ready && state.prefetched.fd >= 0)
+            close(state.prefetched.fd);
+
+    if(backend == ElfAsyncBackends::IoUring)
+        destroy_ring();
+}
@@ -0,0 +1,106 @@
+#include <elf_batch.hpp>
+using namespace elf_batch;
+
+ElfBatch::ElfBatch(uint32_t workers, bool with_colors)
+    : worker_amnt(workers), colors(with_colors), window(0), next_to_print(0)
+{
+    if(worker_amnt == 0)
+        worker_amnt = std::thread::hardware_concurrency();
+    if(worker_amnt == 0)
+        worker_amnt = 1;
+
+    window = worker_amnt * ELF_BATCH_WINDOW_PER_WORKER;
+}
+
+/* Take the next file from the worker's own queue, or steal one from another worker.
+ * Both take from the front, so every queue is drained lowest-numbered file first, which
+ * keeps the oldest unprinted file always being worked on.
+ * */
+bool ElfBatch::take_file(uint32_t worker, uint32_t &file)
+{
+    for(uint32_t i = 0; i < worker_amnt; i++)
+    {
+        struct worker_queue &queue = queues[(worker + i) % worker_amnt];
+        std::lock_guard<std::mutex> guard(queue.lock);
+
+        if(queue.files.empty())
+            continue;
+
+        file = queue.files.front();
+        queue.files.pop_front();
+
+        return true;
+    }
+
+    return false;
+}
+
+void ElfBatch::run_worker(uint32_t worker, const std::vector<const char *> &files, decode_function &decode)
+{
+    ElfOutput out(colors);
+    uint32_t file;
+
+    while(take_file(worker, file))
+    {
+        /* Don't get more than `window` files ahead of what has been printed. */
+        {
+            std::unique_lock<std::mutex> guard(output_lock);
+            window_moved.wait(guard, [this, file] () { return file < next_to_print + window; });
+        }
+
+        out.clear();
+        decode(file, files[file], out);
+
+        {
+            std::lock_guard<std::mutex> guard(output_lock);
+            struct output_slot &slot = slots[file % window];
+
+            /* The slot's (already printed) buffer becomes this worker's next one. */
+            out.swap_buffer(slot.data, slot.size);
+            slot.ready = true;
+        }
+        slot_ready.notify_one();
+    }
+}
+
+void ElfBatch::run(const std::vector<const char *> &files, decode_function decode, int out)
+{
+    uint32_t amnt = files.size();
+
+    queues = std::vector<struct worker_queue>(worker_amnt);
+    slots = std::vector<struct output_slot>(window);
+    next_to_print = 0;
+
+    for(uint32_t i = 0; i < amnt; i++)
+        queues[i % worker_amnt].files.push_back(i);
+
+    std::vector<std::thread> workers;
+    for(uint32_t i = 0; i < worker_amnt; i++)
+        workers.emplace_back(&ElfBatch::run_worker, this, i, std::cref(files), std::ref(decode));
+
+    /* Print each file's output as soon as everything before it has been printed. */
+    std::vector<char> printing;
+    size_t printing_size = 0;
+
+    while(next_to_print < amnt)
+    {
+        {
+            std::unique_lock<std::mutex> guard(output_lock);
+            struct output_slot &next = slots[next_to_print % window];
+
+            slot_ready.wait(guard, [&next] () { return next.ready; });
+
+            /* Leave the last buffer that was printed in the slot, for a worker to reuse. */
+            printing.swap(next.data);
+            std::swap(printing_size, next.size);
+            next.ready = false;
+            next_to_print++;
+        }
+        window_moved.notify_all();
+
+        ElfOutput::write_all(out, printing.data(), printing_size);
+    }
+
+    for(auto &worker : workers)
+        worker.join();
+}
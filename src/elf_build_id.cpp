@@ -0,0 +1,132 @@
+#include <elf_build_id.hpp>
+#include <algorithm>
+#include <fcntl.h>
+using namespace elf_build_id;
+
+void ElfBuildIdIndex::add(const uint8_t *build_id, uint32_t build_id_size, std::string_view path)
+{
+    struct index_entry entry;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.build_id_size = std::min<uint32_t>(build_id_size, ELF_BUILD_ID_MAX_SIZE);
+    memcpy(entry.build_id, build_id, entry.build_id_size);
+    entry.path_size = path.size();
+
+    std::lock_guard<std::mutex> guard(entries_lock);
+
+    entry.path_offset = paths.size();
+    entries.push_back(entry);
+    paths.append(path);
+}
+
+bool ElfBuildIdIndex::write(const char *path)
+{
+    std::lock_guard<std::mutex> guard(entries_lock);
+
+    /* Files that share a build ID (copies of the same binary) end up in path order, so the same
+     * files always give the same index however the threads that found them were scheduled.
+     * */
+    std::sort(entries.begin(), entries.end(), [this] (const struct index_entry &a, const struct index_entry &b) {
+        if(entry_less(a, b) || entry_less(b, a))
+            return entry_less(a, b);
+        return std::string_view(paths).substr(a.path_offset, a.path_size) < std::string_view(paths).substr(b.path_offset, b.path_size);
+    });
+
+    struct index_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ELF_BUILD_ID_INDEX_MAGIC, sizeof(ELF_BUILD_ID_INDEX_MAGIC));
+    header.version = ELF_BUILD_ID_INDEX_VERSION;
+    header.entry_amnt = entries.size();
+
+    /* Written next to the index and renamed over it, so a crash leaves the old one intact. */
+    std::string temporary_path = std::string(path) + ".tmp";
+    int fd = open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if(fd < 0)
+        return false;
+
+    ElfOutput::write_all(fd, (const char *) &header, sizeof(header));
+    ElfOutput::write_all(fd, (const char *) entries.data(), entries.size() * sizeof(struct index_entry));
+    ElfOutput::write_all(fd, paths.data(), paths.size());
+
+    bool written = fsync(fd) == 0 && rename(temporary_path.c_str(), path) == 0;
+    close(fd);
+
+    return written;
+}
+
+bool ElfBuildIdIndex::lookup(const char *index_path, const uint8_t *build_id, uint32_t build_id_size, std::string &path)
+{
+    int fd = open(index_path, O_RDONLY | O_CLOEXEC);
+    struct stat index_stats;
+
+    if(fd < 0)
+        return false;
+    if(fstat(fd, &index_stats) < 0 || (size_t) index_stats.st_size < sizeof(struct index_header))
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t index_size = index_stats.st_size;
+    const uint8_t *index = (const uint8_t *) mmap(nullptr, index_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(index == MAP_FAILED)
+        return false;
+
+    struct index_header header;
+    memcpy(&header, index, sizeof(header));
+
+    size_t paths_start = sizeof(header) + (size_t) header.entry_amnt * sizeof(struct index_entry);
+    bool found = false;
+
+    if(memcmp(header.magic, ELF_BUILD_ID_INDEX_MAGIC, sizeof(ELF_BUILD_ID_INDEX_MAGIC)) == 0
+        && header.version == ELF_BUILD_ID_INDEX_VERSION && paths_start <= index_size)
+    {
+        const struct index_entry *first = (const struct index_entry *) (index + sizeof(header));
+        const struct index_entry *last = first + header.entry_amnt;
+        struct index_entry wanted;
+
+        memset(&wanted, 0, sizeof(wanted));
+        wanted.build_id_size = std::min<uint32_t>(build_id_size, ELF_BUILD_ID_MAX_SIZE);
+        memcpy(wanted.build_id, build_id, wanted.build_id_size);
+
+        const struct index_entry *entry = std::lower_bound(first, last, wanted, entry_less);
+
+        if(entry != last && !entry_less(wanted, *entry)
+            && entry->path_offset <= index_size - paths_start && entry->path_size <= index_size - paths_start - entry->path_offset)
+        {
+            path.assign((const char *) index + paths_start + entry->path_offset, entry->path_size);
+            found = true;
+        }
+    }
+
+    munmap((void *) index, index_size);
+    return found;
+}
+
+uint32_t ElfBuildIdIndex::parse_build_id(const char *hex, uint8_t build_id[ELF_BUILD_ID_MAX_SIZE])
+{
+    auto nibble = [] (char c) -> int {
+        if(c >= '0' && c <= '9') return c - '0';
+        if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    size_t length = strlen(hex);
+    if(length == 0 || length % 2 != 0 || length / 2 > ELF_BUILD_ID_MAX_SIZE)
+        return 0;
+
+    for(size_t i = 0; i < length; i += 2)
+    {
+        int high = nibble(hex[i]), low = nibble(hex[i + 1]);
+
+        if(high < 0 || low < 0)
+            return 0;
+        build_id[i / 2] = (high << 4) | low;
+    }
+
+    return length / 2;
+}
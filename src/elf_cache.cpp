@@ -0,0 +1,375 @@
+#include <elf_cache.hpp>
+#include <fcntl.h>
+#include <sys/file.h>
+using namespace elf_cache;
+
+/* Records are kept 8 byte aligned, so the program headers in them can be used in place. */
+static size_t get_record_size(uint32_t pheader_amnt)
+{
+    size_t size = sizeof(struct ElfFileSummary) + (size_t) pheader_amnt * sizeof(struct ElfProgramHeader::ProgramHeader);
+    return (size + 7) & ~(size_t) 7;
+}
+
+ElfDecodeCache::ElfDecodeCache(const char *path)
+    : cache_path(path), cache_fd(-1), cache_data(nullptr), cache_size(0), valid_size(0), stale_amnt(0)
+{
+    cache_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    /* Without a cache file everything still works; it just does not get faster. */
+    if(cache_fd < 0)
+    {
+        fprintf(stderr, "\nUnable to open the cache `%s` (%s); continuing without it.\n", path, strerror(errno));
+        return;
+    }
+
+    load_records();
+}
+
+void ElfDecodeCache::load_records()
+{
+    struct stat cache_stats;
+    if(fstat(cache_fd, &cache_stats) != 0 || (size_t) cache_stats.st_size < sizeof(struct cache_header))
+        return;
+
+    cache_size = cache_stats.st_size;
+    void *mapped = mmap(nullptr, cache_size, PROT_READ, MAP_SHARED, cache_fd, 0);
+    if(mapped == MAP_FAILED)
+    {
+        cache_size = 0;
+        return;
+    }
+    cache_data = (const uint8_t *) mapped;
+
+    /* A cache from another version gets replaced by the next `save`. */
+    struct cache_header header;
+    memcpy(&header, cache_data, sizeof(header));
+    if(memcmp(header.magic, ELF_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != ELF_CACHE_VERSION
+        || header.summary_size != sizeof(struct ElfFileSummary))
+        return;
+
+    size_t offset = sizeof(struct cache_header);
+    std::unordered_map<struct ElfCacheKey, struct ElfCacheKey, ElfCacheKeyHash> latest_records;
+
+    while(cache_size - offset >= sizeof(struct ElfFileSummary))
+    {
+        const struct ElfFileSummary *summary = (const struct ElfFileSummary *) (cache_data + offset);
+
+        /* Anything from here on was cut short (or was never written properly); the next `save` drops it. */
+        if(summary->record_magic != ELF_CACHE_RECORD_MAGIC || summary->record_size != get_record_size(summary->pheader_amnt)
+            || summary->record_size > cache_size - offset || summary->build_id_size > ELF_BUILD_ID_MAX_SIZE)
+            break;
+
+        /* A later record for the same file (device and inode) means it changed; the older one is stale. */
+        struct ElfCacheKey file = { summary->key.device, summary->key.inode, 0, 0 };
+        auto [latest, added] = latest_records.try_emplace(file, summary->key);
+        if(!added)
+        {
+            records.erase(latest->second);
+            latest->second = summary->key;
+            stale_amnt++;
+        }
+
+        records[summary->key] = offset;
+
+        offset += summary->record_size;
+    }
+
+    valid_size = offset;
+}
+
+bool ElfDecodeCache::lookup(int directory_fd, const char *path, struct ElfSummaryView &view)
+{
+    struct stat file_stats;
+
+    if(records.empty() || fstatat(directory_fd, path, &file_stats, 0) != 0 || !S_ISREG(file_stats.st_mode))
+        return false;
+
+    auto found = records.find(make_key(file_stats));
+    if(found == records.end())
+        return false;
+
+    get_summary(found->second, view);
+    return true;
+}
+
+bool ElfDecodeCache::contains(int directory_fd, const char *name, uint64_t &record)
+{
+    struct stat file_stats;
+
+    if(records.empty() || fstatat(directory_fd, name, &file_stats, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(file_stats.st_mode))
+        return false;
+
+    auto found = records.find(make_key(file_stats));
+    if(found == records.end())
+        return false;
+
+    record = found->second;
+    return true;
+}
+
+void ElfDecodeCache::get_summary(uint64_t record, struct ElfSummaryView &view)
+{
+    memcpy(&view.summary, cache_data + record, sizeof(view.summary));
+    view.pheaders = (const struct ElfProgramHeader::ProgramHeader *) (cache_data + record + sizeof(struct ElfFileSummary));
+}
+
+ElfStatus ElfDecodeCache::summarize(ElfSection &elf_sections, ElfNotes &notes, const struct ElfCacheKey &key, struct ElfSummaryView &view)
+{
+    struct ElfFileSummary &summary = view.summary;
+
+    /* Everything that goes into a summary; a file that is broken never makes it into the cache. */
+    ELF_TRY(elf_sections.get_program_header_table())
+    ELF_TRY(elf_sections.get_section_header_table())
+
+    ELF_TRY(notes.get_notes())
+
+    /* Padding included, so what goes into the cache file does not depend on what was on the stack. */
+    memset(&summary, 0, sizeof(summary));
+
+    summary.header = elf_sections.get_header();
+    summary.key = key;
+    summary.record_magic = ELF_CACHE_RECORD_MAGIC;
+    summary.pheader_amnt = elf_sections.get_program_header_amnt();
+    summary.record_size = get_record_size(summary.pheader_amnt);
+    summary.section_amnt = elf_sections.get_section_amnt();
+
+    const struct ElfSection::SectionTable &sections = elf_sections.get_sections();
+
+    /* Straight off the flags, so there is no list of the allocated sections to allocate. */
+    for(uint32_t i = 0; i < summary.section_amnt; i++)
+    {
+        if(!(sections.flags[i] & (uint64_t) SectionFlags::SF_ALLOC))
+            continue;
+
+        summary.allocated_amnt++;
+        summary.allocated_size += sections.types[i] == (uint32_t) SectionTypes::SHT_NOBITS ? 0 : sections.sizes[i];
+    }
+
+    summary.bss_size = elf_sections.get_total_size_by_type(SectionTypes::SHT_NOBITS);
+    summary.has_symbols = elf_sections.find_section_by_type(SectionTypes::SHT_SYMTAB) < summary.section_amnt;
+    summary.has_debug_info = elf_sections.find_section_by_name(".debug_info") < summary.section_amnt;
+
+    std::basic_string_view<uint8_t> build_id = notes.get_build_id();
+    summary.build_id_size = std::min<size_t>(build_id.size(), ELF_BUILD_ID_MAX_SIZE);
+    memcpy(summary.build_id, build_id.data(), summary.build_id_size);
+
+    view.pheaders = summary.pheader_amnt > 0 ? &elf_sections.get_program_header(0) : nullptr;
+    return ElfStatus();
+}
+
+void ElfDecodeCache::insert(const struct ElfSummaryView &view)
+{
+    const uint8_t *summary = (const uint8_t *) &view.summary;
+    size_t pheaders_size = (size_t) view.summary.pheader_amnt * sizeof(struct ElfProgramHeader::ProgramHeader);
+    std::lock_guard<std::mutex> guard(pending_lock);
+
+    pending.insert(pending.end(), summary, summary + sizeof(view.summary));
+    pending.insert(pending.end(), (const uint8_t *) view.pheaders, (const uint8_t *) view.pheaders + pheaders_size);
+    pending.resize(pending.size() + view.summary.record_size - sizeof(view.summary) - pheaders_size, 0);
+}
+
+/* Write the header, the live records (if `with_live_records`) and the pending ones at `offset`. */
+bool ElfDecodeCache::write_records(int fd, size_t offset, bool with_live_records)
+{
+    if(lseek(fd, offset, SEEK_SET) < 0)
+        return false;
+
+    if(offset == 0)
+    {
+        struct cache_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, ELF_CACHE_MAGIC, sizeof(header.magic));
+        header.version = ELF_CACHE_VERSION;
+        header.summary_size = sizeof(struct ElfFileSummary);
+
+        ElfOutput::write_all(fd, (const char *) &header, sizeof(header));
+    }
+
+    if(with_live_records)
+    {
+        for(const auto &[key, record] : records)
+            ElfOutput::write_all(fd, (const char *) cache_data + record, ((const struct ElfFileSummary *) (cache_data + record))->record_size);
+    }
+
+    ElfOutput::write_all(fd, (const char *) pending.data(), pending.size());
+    return true;
+}
+
+/* Lock the cache file that is at `cache_path` now. Another scan may have rewritten it (renamed a
+ * new file over it) since it was opened, or while waiting for the lock; whatever is written to the
+ * file that was replaced is lost, so the new one is opened and locked instead.
+ * Returns false if the file could not be locked; `replaced` is set if it is not the one the cache was opened with.
+ * */
+bool ElfDecodeCache::lock_current_file(bool &replaced)
+{
+    struct stat held_stats, current_stats;
+
+    replaced = false;
+
+    while(true)
+    {
+        if(flock(cache_fd, LOCK_EX) != 0 || fstat(cache_fd, &held_stats) != 0)
+            return false;
+
+        if(stat(cache_path.c_str(), &current_stats) == 0
+            && held_stats.st_dev == current_stats.st_dev && held_stats.st_ino == current_stats.st_ino)
+            return true;
+
+        int current_fd = open(cache_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if(current_fd < 0)
+            return false;
+
+        flock(cache_fd, LOCK_UN);
+        close(cache_fd);
+        cache_fd = current_fd;
+        replaced = true;
+    }
+}
+
+bool ElfDecodeCache::save()
+{
+    std::lock_guard<std::mutex> guard(pending_lock);
+
+    bool rewrite = valid_size == 0 || stale_amnt > records.size();
+    if(cache_fd < 0 || (pending.empty() && !rewrite))
+        return true;
+
+    /* Other scans may be sharing the cache file; appends from each of them stay whole. */
+    bool replaced = false;
+    struct stat cache_stats;
+    bool saved = lock_current_file(replaced) && fstat(cache_fd, &cache_stats) == 0;
+
+    if(saved)
+    {
+        /* What was read in when the cache was opened is not what is there now. */
+        bool changed = replaced || (size_t) cache_stats.st_size != cache_size;
+
+        if(rewrite && !changed)
+        {
+            /* Written next to the cache and renamed over it, so a crash leaves the old one intact. */
+            std::string temporary_path = cache_path + ".tmp";
+            int temporary_fd = open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            saved = temporary_fd >= 0 && write_records(temporary_fd, 0, valid_size != 0) && fsync(temporary_fd) == 0
+                && rename(temporary_path.c_str(), cache_path.c_str()) == 0;
+            if(temporary_fd >= 0)
+                close(temporary_fd);
+        }
+        else if(changed)
+        {
+            /* Someone else appended (or rewrote it) since the cache was opened; add to the end of what they wrote. */
+            saved = write_records(cache_fd, cache_stats.st_size, false);
+        }
+        else
+        {
+            /* Whatever was cut short after the last good record gets written over. */
+            saved = ftruncate(cache_fd, valid_size) == 0 && write_records(cache_fd, valid_size, false);
+        }
+    }
+
+    if(!saved)
+    {
+        fprintf(stderr, "\nUnable to save the cache `%s` (%s); the new summaries were not saved.\n",
+            cache_path.c_str(), strerror(errno));
+        flock(cache_fd, LOCK_UN);
+        return false;
+    }
+
+    flock(cache_fd, LOCK_UN);
+    pending.clear();
+    return true;
+}
+
+void ElfDecodeCache::print_summary(const struct ElfSummaryView &view, const char *filename, ElfOutput &out)
+{
+    const struct ElfFileSummary &summary = view.summary;
+    const struct ElfHeader::ELF_header &header = summary.header;
+
+    out.text(filename).text(":\n");
+    out.text("\tType: ").description((const char *) get_ELF_file_type_name((ELF_file_types) header.ELF_file_type))
+        .text("  Machine: ").description((const char *) get_ELF_machine_type_name((ELF_machine_types) header.ELF_machine_type))
+        .text("  Class: ").description((const char *) get_ELF_type_name((ELF_types) header.ELF_type))
+        .text(" ").description((const char *) get_ELF_endianess_name((ELF_endianess) header.ELF_endianess))
+        .text("  Entry: ").value_hex(header.ELF_entry).text("\n");
+
+    out.text("\tSegments: ").color(ELF_COLOR_VALUE).decimal(summary.pheader_amnt).color(ELF_COLOR_RESET).text("\n");
+    for(uint32_t i = 0; i < summary.pheader_amnt; i++)
+    {
+        const struct ElfProgramHeader::ProgramHeader &entry = view.pheaders[i];
+        const char flags[] = {
+            entry.p_flags & (uint32_t) SegmentFlags::SF_READ ? 'R' : '-',
+            entry.p_flags & (uint32_t) SegmentFlags::SF_WRITE ? 'W' : '-',
+            entry.p_flags & (uint32_t) SegmentFlags::SF_EXECUTE ? 'X' : '-'
+        };
+
+        out.text("\t\t").description((const char *) get_entry_type_name((SegmentTypes) entry.p_type))
+            .text("  Offset: ").value_hex(entry.p_offset)
+            .text("  Address: ").value_hex(entry.p_virtual_address)
+            .text("  File Size: ").value_hex(entry.p_size)
+            .text("  Memory Size: ").value_hex(entry.p_memory_size)
+            .text("  Flags: ").description(std::string_view(flags, sizeof(flags))).text("\n");
+    }
+
+    out.text("\tSections: ").color(ELF_COLOR_VALUE).decimal(summary.section_amnt).color(ELF_COLOR_RESET)
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(summary.allocated_amnt).text(" occupying memory, ")
+        .decimal(summary.allocated_size).text(" bytes in the file, ").decimal(summary.bss_size).text(" bytes of bss").color(ELF_COLOR_RESET).text(")\n");
+    out.text("\tSymbols: ").description(summary.has_symbols ? "yes" : "no (stripped)")
+        .text("  Debug Info: ").description(summary.has_debug_info ? "yes" : "no").text("\n");
+
+    out.text("\tBuild ID: ").color(ELF_COLOR_VALUE);
+    if(summary.build_id_size == 0)
+        out.text("none");
+    ElfNotes::print_build_id(summary.build_id, summary.build_id_size, out);
+    out.color(ELF_COLOR_RESET).text("\n\n");
+}
+
+void ElfDecodeCache::print_summary_json(const struct ElfSummaryView &view, ElfOutput &out)
+{
+    const struct ElfFileSummary &summary = view.summary;
+    const struct ElfHeader::ELF_header &header = summary.header;
+
+    out.json_key("class").decimal(header.ELF_type).character(',')
+        .json_key("data").decimal(header.ELF_endianess).character(',')
+        .json_key("type").decimal(header.ELF_file_type).character(',')
+        .json_key("type_name").json_string((const char *) get_ELF_file_type_name((ELF_file_types) header.ELF_file_type)).character(',')
+        .json_key("machine").decimal(header.ELF_machine_type).character(',')
+        .json_key("machine_name").json_string((const char *) get_ELF_machine_type_name((ELF_machine_types) header.ELF_machine_type)).character(',')
+        .json_key("entry").decimal(header.ELF_entry).character(',')
+        .json_key("segments").character('[');
+
+    for(uint32_t i = 0; i < summary.pheader_amnt; i++)
+    {
+        const struct ElfProgramHeader::ProgramHeader &entry = view.pheaders[i];
+
+        if(i > 0)
+            out.character(',');
+
+        out.character('{')
+            .json_key("type").decimal(entry.p_type).character(',')
+            .json_key("flags").decimal(entry.p_flags).character(',')
+            .json_key("offset").decimal(entry.p_offset).character(',')
+            .json_key("vaddr").decimal(entry.p_virtual_address).character(',')
+            .json_key("filesz").decimal(entry.p_size).character(',')
+            .json_key("memsz").decimal(entry.p_memory_size).character(',')
+            .json_key("align").decimal(entry.p_align).character('}');
+    }
+
+    out.text("],").json_key("sections").decimal(summary.section_amnt).character(',')
+        .json_key("allocated_sections").decimal(summary.allocated_amnt).character(',')
+        .json_key("allocated_size").decimal(summary.allocated_size).character(',')
+        .json_key("bss_size").decimal(summary.bss_size).character(',')
+        .json_key("symbols").text(summary.has_symbols ? "true" : "false").character(',')
+        .json_key("debug_info").text(summary.has_debug_info ? "true" : "false").character(',')
+        .json_key("build_id").character('"');
+
+    ElfNotes::print_build_id(summary.build_id, summary.build_id_size, out);
+    out.character('"');
+}
+
+ElfDecodeCache::~ElfDecodeCache()
+{
+    if(cache_data)
+        munmap((void *) cache_data, cache_size);
+    if(cache_fd >= 0)
+        close(cache_fd);
+}
@@ -0,0 +1,71 @@
+#include <elf_context.hpp>
+using namespace elf_context;
+
+ElfStatus ElfDecodeContext::reset(int fd, int8_t &filename, ELF_load_modes mode)
+{
+    /* Made without a file the first time; the tables made for earlier files hold on to `elf_sections`,
+     * so it is reset in place, never replaced.
+     * */
+    if(!elf_sections)
+        elf_sections = new ElfSection(-1, filename, mode);
+
+    ElfStatus status = elf_sections->reset(fd, filename, mode);
+
+    /* Whatever the other decoders got from the last file goes; none of them decodes anything until asked to. */
+    if(symbol_table)
+        symbol_table->reset();
+    if(dynamic_symbol_table)
+        dynamic_symbol_table->reset();
+    if(dynamic)
+        dynamic->reset();
+    if(notes)
+        notes->reset();
+    if(relocations)
+        relocations->reset();
+
+    return status;
+}
+
+ElfSymbolTable &ElfDecodeContext::get_symbol_table(SectionTypes type)
+{
+    ElfSymbolTable *&table = type == SectionTypes::SHT_DYNSYM ? dynamic_symbol_table : symbol_table;
+
+    if(!table)
+        table = new ElfSymbolTable(*elf_sections, type);
+
+    return *table;
+}
+
+ElfDynamic &ElfDecodeContext::get_dynamic()
+{
+    if(!dynamic)
+        dynamic = new ElfDynamic(*elf_sections);
+
+    return *dynamic;
+}
+
+ElfNotes &ElfDecodeContext::get_notes()
+{
+    if(!notes)
+        notes = new ElfNotes(*elf_sections);
+
+    return *notes;
+}
+
+ElfRelocations &ElfDecodeContext::get_relocations()
+{
+    if(!relocations)
+        relocations = new ElfRelocations(*elf_sections);
+
+    return *relocations;
+}
+
+ElfDecodeContext::~ElfDecodeContext()
+{
+    delete symbol_table;
+    delete dynamic_symbol_table;
+    delete dynamic;
+    delete notes;
+    delete relocations;
+    delete elf_sections;
+}
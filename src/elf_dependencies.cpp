@@ -0,0 +1,396 @@
+#include <elf_dependencies.hpp>
+#include <fcntl.h>
+#include <glob.h>
+#include <limits.h>
+using namespace elf_dependencies;
+
+ElfDependencyGraph::ElfDependencyGraph()
+{
+    /* Set-user-ID programs ignore `LD_LIBRARY_PATH`, but nothing is run here. */
+    const char *environment_path = getenv("LD_LIBRARY_PATH");
+
+    if(environment_path)
+    {
+        std::string_view path(environment_path);
+
+        while(!path.empty())
+        {
+            size_t end = path.find_first_of(":;");
+            std::string_view directory = path.substr(0, end);
+
+            if(!directory.empty())
+                library_path.emplace_back(directory);
+            path = end == std::string_view::npos ? std::string_view() : path.substr(end + 1);
+        }
+    }
+
+    read_library_config(ELF_LIBRARY_CONFIG, 0);
+
+    for(const char *directory : { "/lib", "/usr/lib", "/lib64", "/usr/lib64" })
+        system_directories.push_back(directory);
+}
+
+/* Each line is a directory, or `include` and a glob of more files like this one. */
+void ElfDependencyGraph::read_library_config(const char *config, uint32_t depth)
+{
+    FILE *config_file = fopen(config, "r");
+
+    /* Includes that include themselves would never end. */
+    if(!config_file || depth > 8)
+    {
+        if(config_file)
+            fclose(config_file);
+        return;
+    }
+
+    char *line = nullptr;
+    size_t line_size = 0;
+
+    while(getline(&line, &line_size, config_file) > 0)
+    {
+        std::string_view entry(line);
+
+        entry = entry.substr(0, entry.find('#'));
+        while(!entry.empty() && isspace((uint8_t) entry.front()))
+            entry.remove_prefix(1);
+        while(!entry.empty() && isspace((uint8_t) entry.back()))
+            entry.remove_suffix(1);
+
+        if(entry.empty())
+            continue;
+
+        if(entry.substr(0, 8) != "include ")
+        {
+            system_directories.emplace_back(entry);
+            continue;
+        }
+
+        entry.remove_prefix(8);
+        while(!entry.empty() && isspace((uint8_t) entry.front()))
+            entry.remove_prefix(1);
+
+        /* Relative globs are relative to the directory of the file they are in. */
+        std::string pattern(entry);
+        if(pattern[0] != '/')
+        {
+            std::string_view directory(config);
+            pattern = std::string(directory.substr(0, directory.rfind('/') + 1)) + pattern;
+        }
+
+        glob_t matches;
+        if(glob(pattern.c_str(), 0, nullptr, &matches) == 0)
+        {
+            for(size_t i = 0; i < matches.gl_pathc; i++)
+                read_library_config(matches.gl_pathv[i], depth + 1);
+        }
+        globfree(&matches);
+    }
+
+    free(line);
+    fclose(config_file);
+}
+
+void ElfDependencyGraph::decode_library(struct Library &library, const char *real_path)
+{
+    library.is_elf = false;
+    library.is_dynamic = false;
+
+    /* `O_NONBLOCK`: a FIFO where a library was expected must not hold the search up. */
+    int library_fd = open(real_path, O_RDONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+
+    /* Only the header, the program header table and the dynamic section get read in.
+     * Linker scripts (like `libc.so`) and the like fail the header's checks.
+     * */
+    library.status = context.reset(library_fd, *(int8_t *)real_path, ELF_load_modes::Lazy);
+
+    ElfSection &elf_sections = context.get_sections();
+    ElfDynamic &dynamic = context.get_dynamic();
+
+    if(library.status)
+        library.status = elf_sections.get_elf_header();
+    if(library.status)
+        library.status = dynamic.get_dynamic_section();
+
+    if(!library.status)
+    {
+        if(library_fd >= 0)
+            close(library_fd);
+        return;
+    }
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    library.is_elf = true;
+    library.elf_class = header.ELF_type;
+    library.machine = header.ELF_machine_type;
+
+    std::vector<std::string_view> needed;
+
+    library.is_dynamic = dynamic.is_present();
+    dynamic.get_needed(needed);
+
+    library.soname = dynamic.get_soname();
+    library.rpath = dynamic.get_rpath();
+    library.runpath = dynamic.get_runpath();
+    library.needed.assign(needed.begin(), needed.end());
+
+    close(library_fd);
+}
+
+uint32_t ElfDependencyGraph::add_file(const char *path)
+{
+    char real_path[PATH_MAX];
+
+    if(!realpath(path, real_path))
+        return ELF_LIBRARY_NOT_FOUND;
+
+    auto [found, added] = library_index.try_emplace(real_path, libraries.size());
+    if(!added)
+        return found->second;
+
+    /* Kept under the path it was first found at, like the dynamic linker reports it. */
+    libraries.emplace_back();
+    libraries.back().path = path;
+    libraries.back().resolved = false;
+    decode_library(libraries.back(), real_path);
+
+    return found->second;
+}
+
+uint32_t ElfDependencyGraph::try_library(const std::string &path, const struct Library &from)
+{
+    /* `from` may move when `add_file` adds a library; only copies of its fields are used after. */
+    uint8_t elf_class = from.elf_class;
+    uint16_t machine = from.machine;
+    uint32_t node = add_file(path.c_str());
+
+    if(node == ELF_LIBRARY_NOT_FOUND || !libraries[node].is_elf
+        || libraries[node].elf_class != elf_class || libraries[node].machine != machine)
+        return ELF_LIBRARY_NOT_FOUND;
+
+    return node;
+}
+
+uint32_t ElfDependencyGraph::search_path(std::string_view name, std::string_view path, std::string_view origin, const struct Library &from)
+{
+    while(!path.empty())
+    {
+        size_t end = path.find_first_of(":;");
+        std::string directory(path.substr(0, end));
+        path = end == std::string_view::npos ? std::string_view() : path.substr(end + 1);
+
+        for(std::string_view variable : { "$ORIGIN", "${ORIGIN}" })
+        {
+            for(size_t at = directory.find(variable); at != std::string::npos; at = directory.find(variable))
+                directory.replace(at, variable.size(), origin);
+        }
+
+        if(directory.empty())
+            continue;
+
+        uint32_t node = try_library(directory + "/" + std::string(name), from);
+        if(node != ELF_LIBRARY_NOT_FOUND)
+            return node;
+    }
+
+    return ELF_LIBRARY_NOT_FOUND;
+}
+
+uint32_t ElfDependencyGraph::search_directories(std::string_view name, const std::vector<std::string> &directories, const struct Library &from)
+{
+    /* Only depends on the name, the class and the machine, so the result is kept. */
+    std::string key = std::string(name) + '\0' + (char) from.elf_class + std::to_string(from.machine)
+        + (&directories == &library_path ? 'L' : 'S');
+
+    auto cached = resolved_names.find(key);
+    if(cached != resolved_names.end())
+        return cached->second;
+
+    uint32_t node = ELF_LIBRARY_NOT_FOUND;
+
+    for(const auto &directory : directories)
+    {
+        if((node = try_library(directory + "/" + std::string(name), from)) != ELF_LIBRARY_NOT_FOUND)
+            break;
+    }
+
+    resolved_names.emplace(std::move(key), node);
+    return node;
+}
+
+uint32_t ElfDependencyGraph::find_library(std::string_view name, uint32_t from)
+{
+    /* Copied, since `libraries` grows (and moves) while the search goes on. */
+    struct Library requester = libraries[from];
+    std::string_view origin(requester.path);
+    origin = origin.substr(0, origin.rfind('/'));
+
+    /* Names with a slash in them are paths, and are not searched for. */
+    if(name.find('/') != std::string_view::npos)
+        return try_library(std::string(name), requester);
+
+    uint32_t node = ELF_LIBRARY_NOT_FOUND;
+
+    /* `DT_RPATH` is ignored when there is a `DT_RUNPATH`. */
+    if(requester.runpath.empty() && !requester.rpath.empty())
+        node = search_path(name, requester.rpath, origin, requester);
+    if(node == ELF_LIBRARY_NOT_FOUND)
+        node = search_directories(name, library_path, requester);
+    if(node == ELF_LIBRARY_NOT_FOUND && !requester.runpath.empty())
+        node = search_path(name, requester.runpath, origin, requester);
+    if(node == ELF_LIBRARY_NOT_FOUND)
+        node = search_directories(name, system_directories, requester);
+
+    return node;
+}
+
+void ElfDependencyGraph::resolve(uint32_t node)
+{
+    std::vector<uint32_t> pending = { node };
+
+    while(!pending.empty())
+    {
+        uint32_t current = pending.back();
+        pending.pop_back();
+
+        if(current == ELF_LIBRARY_NOT_FOUND || libraries[current].resolved)
+            continue;
+        libraries[current].resolved = true;
+
+        for(uint32_t i = 0; i < libraries[current].needed.size(); i++)
+        {
+            /* `find_library` may add libraries, so nothing in `libraries` is held across it. */
+            std::string name = libraries[current].needed[i];
+            uint32_t dependency = find_library(name, current);
+
+            libraries[current].dependencies.push_back(dependency);
+            pending.push_back(dependency);
+        }
+    }
+}
+
+void ElfDependencyGraph::get_load_order(uint32_t node, std::vector<std::pair<std::string_view, uint32_t>> &load_order)
+{
+    std::vector<uint32_t> loaded = { node };
+    std::vector<bool> visited(libraries.size(), false);
+
+    visited[node] = true;
+
+    /* Breadth first, like the dynamic linker loads them. */
+    for(size_t next = 0; next < loaded.size(); next++)
+    {
+        const struct Library &library = libraries[loaded[next]];
+
+        for(uint32_t i = 0; i < library.dependencies.size(); i++)
+        {
+            std::string_view name = library.needed[i];
+            uint32_t dependency = library.dependencies[i];
+            bool already_loaded = false;
+
+            /* A name that was already loaded (or a library with it as its `DT_SONAME`) is not
+             * searched for again, even if this library's own search paths would not find it.
+             * */
+            for(const auto &[loaded_name, loaded_node] : load_order)
+            {
+                if(loaded_name == name || (loaded_node != ELF_LIBRARY_NOT_FOUND && libraries[loaded_node].soname == name))
+                {
+                    already_loaded = true;
+                    break;
+                }
+            }
+
+            if(already_loaded)
+                continue;
+            if(dependency != ELF_LIBRARY_NOT_FOUND)
+            {
+                if(visited[dependency])
+                    continue;
+
+                visited[dependency] = true;
+                loaded.push_back(dependency);
+            }
+
+            load_order.push_back({ name, dependency });
+        }
+    }
+
+    /* Some names only get loaded by a library further down; those count as found after all. */
+    std::erase_if(load_order, [&] (const std::pair<std::string_view, uint32_t> &entry) {
+        if(entry.second != ELF_LIBRARY_NOT_FOUND)
+            return false;
+
+        for(uint32_t loaded_node : loaded)
+        {
+            if(libraries[loaded_node].soname == entry.first)
+                return true;
+        }
+        return false;
+    });
+}
+
+void ElfDependencyGraph::print_dependencies(uint32_t node, const char *filename, ElfOutput &out)
+{
+    out.text(filename).text(":\n");
+
+    if(node == ELF_LIBRARY_NOT_FOUND || !libraries[node].is_elf)
+    {
+        out.text("\tnot an ELF binary file\n");
+        return;
+    }
+    if(!libraries[node].is_dynamic)
+    {
+        out.text("\tnot dynamically linked\n");
+        return;
+    }
+
+    std::vector<std::pair<std::string_view, uint32_t>> names;
+    get_load_order(node, names);
+
+    for(const auto &[name, dependency] : names)
+    {
+        out.text("\t").description(name).text(" => ");
+
+        if(dependency == ELF_LIBRARY_NOT_FOUND)
+            out.color(ELF_COLOR_VALUE).text("not found").color(ELF_COLOR_RESET).text("\n");
+        else
+            out.text(libraries[dependency].path).text("\n");
+    }
+}
+
+void ElfDependencyGraph::print_dependencies_json(uint32_t node, ElfOutput &out)
+{
+    bool is_elf = node != ELF_LIBRARY_NOT_FOUND && libraries[node].is_elf;
+
+    out.json_key("dynamic").text(is_elf && libraries[node].is_dynamic ? "true" : "false").character(',')
+        .json_key("soname").json_string(is_elf ? std::string_view(libraries[node].soname) : std::string_view()).character(',')
+        .json_key("needed").character('[');
+
+    for(uint32_t i = 0; is_elf && i < libraries[node].needed.size(); i++)
+    {
+        if(i > 0)
+            out.character(',');
+        out.json_string(libraries[node].needed[i]);
+    }
+
+    out.text("],").json_key("dependencies").character('[');
+
+    std::vector<std::pair<std::string_view, uint32_t>> names;
+    if(is_elf)
+        get_load_order(node, names);
+
+    for(uint32_t i = 0; i < names.size(); i++)
+    {
+        if(i > 0)
+            out.character(',');
+
+        out.character('{').json_key("name").json_string(names[i].first).character(',').json_key("path");
+
+        if(names[i].second == ELF_LIBRARY_NOT_FOUND)
+            out.text("null");
+        else
+            out.json_string(libraries[names[i].second].path);
+        out.character('}');
+    }
+
+    out.character(']');
+}
@@ -0,0 +1,238 @@
+#include <elf_dynamic.hpp>
+using namespace elf_dynamic;
+
+ElfDynamic::ElfDynamic(ElfSection &sections)
+    : elf_sections(sections), segment_index(0), entries(sections.get_decoder()->ELF_get_arena()), entries_decoded(false)
+{
+    reset();
+}
+
+void ElfDynamic::reset()
+{
+    /* There is no `PT_DYNAMIC` segment until the program header table has been decoded and searched. */
+    segment_index = UINT32_MAX;
+    entries.reset();
+    dynamic_strings = ElfStringTable();
+    entries_decoded = false;
+    entries_status = ElfStatus();
+}
+
+bool ElfDynamic::get_file_offset(uint64_t address, uint64_t &offset)
+{
+    uint32_t segment_amnt = elf_sections.get_program_header_amnt();
+
+    for(uint32_t i = 0; i < segment_amnt; i++)
+    {
+        const struct ElfProgramHeader::ProgramHeader &segment = elf_sections.get_program_header(i);
+
+        /* Only the part of the segment that is in the file counts. */
+        if(segment.p_type == (uint32_t) SegmentTypes::ST_LOAD
+            && address - segment.p_virtual_address < segment.p_size)
+        {
+            offset = segment.p_offset + (address - segment.p_virtual_address);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template<typename Traits>
+ElfStatus ElfDynamic::decode_dynamic_section()
+{
+    const struct ElfProgramHeader::ProgramHeader &segment = elf_sections.get_program_header(segment_index);
+    uint64_t amnt = segment.p_size / Traits::dynamic_size;
+
+    if(amnt == 0)
+        return ElfStatus();
+
+    ElfResult<ElfSpan> table = elf_sections.get_decoder()->ELF_table_at(segment.p_offset, amnt, Traits::dynamic_size);
+    if(!table)
+        return table.error();
+
+    for(uint64_t i = 0; i < amnt; i++)
+    {
+        const auto entry = Traits::template overlay<typename Traits::Dynamic>(table->entry(i, Traits::dynamic_size));
+        uint64_t tag = (uint64_t) Traits::get(entry.d_tag);
+
+        /* Whatever comes after `DT_NULL` is padding. */
+        if(tag == (uint64_t) DynamicTags::DT_NULL)
+            break;
+
+        entries.push_back({ tag, (uint64_t) Traits::get(entry.d_val) });
+    }
+
+    return ElfStatus();
+}
+
+ElfStatus ElfDynamic::get_dynamic_section()
+{
+    if(entries_decoded) return entries_status;
+    entries_decoded = true;
+
+    /* The dynamic section is found through the program header table. */
+    entries_status = elf_sections.get_program_header_table();
+    if(!entries_status)
+        return entries_status;
+
+    uint32_t segment_amnt = elf_sections.get_program_header_amnt();
+
+    for(segment_index = 0; segment_index < segment_amnt; segment_index++)
+    {
+        if(elf_sections.get_program_header(segment_index).p_type == (uint32_t) SegmentTypes::ST_DYNAMIC)
+            break;
+    }
+
+    if(segment_index == segment_amnt)
+        return entries_status;
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    entries_status = ELF_dispatch(header.ELF_type, header.ELF_endianess, [this] <typename Traits> () {
+        return decode_dynamic_section<Traits>();
+    });
+
+    if(!entries_status)
+    {
+        entries.clear();
+        return entries_status;
+    }
+
+    return entries_status = load_string_table();
+}
+
+ElfStatus ElfDynamic::load_string_table()
+{
+    uint64_t address = get_value(DynamicTags::DT_STRTAB);
+    uint64_t size = get_value(DynamicTags::DT_STRSZ);
+    uint64_t offset = 0;
+
+    if(address == 0 || size == 0 || !get_file_offset(address, offset))
+        return ElfStatus();
+
+    /* A segment can claim more of the file than there is. */
+    if(offset >= elf_sections.get_decoder()->ELF_get_binary_size())
+        return ELF_errors::Invalid_ELF_Dynamic;
+
+    /* A broken `DT_STRSZ` only shortens the table, it never reads past the end of the file. */
+    size = std::min<uint64_t>(size, elf_sections.get_decoder()->ELF_get_binary_size() - offset);
+
+    ElfResult<const uint8_t *> table = elf_sections.get_decoder()->ELF_data_at(offset, size);
+    if(!table)
+        return table.error();
+
+    dynamic_strings = ElfStringTable(*table, size);
+    return ElfStatus();
+}
+
+uint64_t ElfDynamic::get_value(DynamicTags tag, uint64_t fallback)
+{
+    get_dynamic_section();
+
+    for(const auto &entry : entries)
+    {
+        if(entry.d_tag == (uint64_t) tag)
+            return entry.d_value;
+    }
+
+    return fallback;
+}
+
+std::string_view ElfDynamic::get_tag_string(DynamicTags tag)
+{
+    get_dynamic_section();
+
+    for(const auto &entry : entries)
+    {
+        if(entry.d_tag == (uint64_t) tag)
+            return dynamic_strings.get_string(entry.d_value);
+    }
+
+    return std::string_view();
+}
+
+uint32_t ElfDynamic::get_needed(std::vector<std::string_view> &needed)
+{
+    get_dynamic_section();
+
+    uint32_t amnt = 0;
+
+    for(const auto &entry : entries)
+    {
+        if(entry.d_tag != (uint64_t) DynamicTags::DT_NEEDED)
+            continue;
+
+        needed.push_back(dynamic_strings.get_string(entry.d_value));
+        amnt++;
+    }
+
+    return amnt;
+}
+
+/* Tags whose value is an offset into the dynamic string table. */
+static bool is_string_tag(uint64_t tag)
+{
+    return tag == (uint64_t) DynamicTags::DT_NEEDED || tag == (uint64_t) DynamicTags::DT_SONAME
+        || tag == (uint64_t) DynamicTags::DT_RPATH || tag == (uint64_t) DynamicTags::DT_RUNPATH;
+}
+
+void ElfDynamic::print_dynamic_section(ElfOutput &out)
+{
+    if(!is_present())
+        return;
+
+    out.text("\tDynamic Section (").color(ELF_COLOR_DESCRIPTION).decimal(entries.size()).text(" entries").color(ELF_COLOR_RESET).text("):\n");
+
+    for(const auto &entry : entries)
+    {
+        out.text("\t\t").description((const char *) get_dynamic_tag_name((DynamicTags) entry.d_tag)).text(":\t");
+
+        if(is_string_tag(entry.d_tag))
+            out.description(dynamic_strings.get_string(entry.d_value));
+        else
+            out.value_hex(entry.d_value);
+        out.text("\n");
+    }
+
+    out.text("\n");
+}
+
+void ElfDynamic::print_dynamic_section_json(ElfOutput &out)
+{
+    get_dynamic_section();
+
+    out.json_key("dynamic").character('{')
+        .json_key("soname").json_string(get_soname()).character(',')
+        .json_key("rpath").json_string(get_rpath()).character(',')
+        .json_key("runpath").json_string(get_runpath()).character(',')
+        .json_key("flags").decimal(get_flags()).character(',')
+        .json_key("flags_1").decimal(get_flags_1()).character(',')
+        .json_key("needed").character('[');
+
+    /* Straight from the entries, so there is no list of them to allocate. */
+    uint32_t needed_amnt = 0;
+    for(const auto &entry : entries)
+    {
+        if(entry.d_tag != (uint64_t) DynamicTags::DT_NEEDED)
+            continue;
+
+        if(needed_amnt++ > 0)
+            out.character(',');
+        out.json_string(dynamic_strings.get_string(entry.d_value));
+    }
+
+    out.text("],").json_key("entries").character('[');
+
+    for(uint32_t i = 0; i < entries.size(); i++)
+    {
+        if(i > 0)
+            out.character(',');
+
+        out.character('{')
+            .json_key("tag").decimal(entries[i].d_tag).character(',')
+            .json_key("tag_name").json_string((const char *) get_dynamic_tag_name((DynamicTags) entries[i].d_tag)).character(',')
+            .json_key("value").decimal(entries[i].d_value).character('}');
+    }
+
+    out.text("]}");
+}
@@ -0,0 +1,205 @@
+#include <elf_hash.hpp>
+using namespace elf_hash;
+
+ElfHashTable::ElfHashTable(ElfSection &sections)
+    : elf_sections(sections), hash_index(0), symbol_index(0), hash_type(SectionTypes::SHT_GNU_HASH), bucket_amnt(0), chain_amnt(0),
+      symbol_offset(0), bloom_amnt(0), bloom_shift(0), table_loaded(false)
+{
+    hash_index = elf_sections.find_section_by_type(SectionTypes::SHT_GNU_HASH);
+
+    if(!is_present())
+    {
+        hash_type = SectionTypes::SHT_HASH;
+        hash_index = elf_sections.find_section_by_type(SectionTypes::SHT_HASH);
+    }
+}
+
+/* Split the table into its parts (the bloom filter of `.gnu.hash`, the buckets and the chains),
+ * each checked once against the section, so the lookups read them without checking anything again.
+ * */
+template<typename Traits>
+ElfStatus ElfHashTable::layout_table()
+{
+    uint64_t header_size = hash_type == SectionTypes::SHT_GNU_HASH ? 4 * sizeof(uint32_t) : 2 * sizeof(uint32_t);
+
+    if(!table.fits(0, header_size))
+        return ELF_errors::Invalid_ELF_Hash;
+
+    bucket_amnt = table.read<uint32_t, Traits::order>(0);
+    if(bucket_amnt == 0)
+        return ELF_errors::Invalid_ELF_Hash;
+
+    if(hash_type == SectionTypes::SHT_GNU_HASH)
+    {
+        symbol_offset = table.read<uint32_t, Traits::order>(4);
+        bloom_amnt = table.read<uint32_t, Traits::order>(8);
+        bloom_shift = table.read<uint32_t, Traits::order>(12);
+
+        /* The lookups shift the 32 bit hash by it. */
+        if(bloom_shift >= 32)
+            return ELF_errors::Invalid_ELF_Hash;
+
+        ElfResult<ElfSpan> bloom_words = table.subspan(header_size, bloom_amnt, sizeof(typename Traits::Word));
+        if(!bloom_words || bloom_amnt == 0)
+            return ELF_errors::Invalid_ELF_Hash;
+
+        ElfResult<ElfSpan> bucket_words = table.subspan(header_size + bloom_words->size(), bucket_amnt, sizeof(uint32_t));
+        if(!bucket_words)
+            return ELF_errors::Invalid_ELF_Hash;
+
+        /* One hash per symbol from `symbol_offset` on, up to the end of the section. */
+        uint64_t chains_offset = header_size + bloom_words->size() + bucket_words->size();
+        chain_amnt = (table.size() - chains_offset) / sizeof(uint32_t);
+
+        bloom = *bloom_words;
+        buckets = *bucket_words;
+        chains = ElfSpan(table.at(chains_offset), chain_amnt * sizeof(uint32_t));
+        return ElfStatus();
+    }
+
+    chain_amnt = table.read<uint32_t, Traits::order>(4);
+
+    ElfResult<ElfSpan> bucket_words = table.subspan(header_size, bucket_amnt, sizeof(uint32_t));
+    if(!bucket_words)
+        return ELF_errors::Invalid_ELF_Hash;
+
+    ElfResult<ElfSpan> chain_words = table.subspan(header_size + bucket_words->size(), chain_amnt, sizeof(uint32_t));
+    if(!chain_words)
+        return ELF_errors::Invalid_ELF_Hash;
+
+    buckets = *bucket_words;
+    chains = *chain_words;
+    return ElfStatus();
+}
+
+ElfStatus ElfHashTable::load_table()
+{
+    if(table_loaded) return table_status;
+    table_loaded = true;
+
+    table_status = elf_sections.get_section_header_table();
+    if(!table_status || !is_present())
+        return table_status;
+
+    const struct ElfSection::SectionTable &sections = elf_sections.get_sections();
+
+    symbol_index = sections.links[hash_index];
+    if(symbol_index >= elf_sections.get_section_amnt())
+        return table_status = ELF_errors::Invalid_ELF_Hash;
+
+    ElfResult<ElfSpan> loaded = elf_sections.get_decoder()->ELF_table_at(sections.offsets[hash_index], sections.sizes[hash_index], 1);
+    if(!loaded)
+        return table_status = loaded.error();
+
+    table = *loaded;
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+    table_status = ELF_dispatch(header.ELF_type, header.ELF_endianess, [this] <typename Traits> () {
+        return layout_table<Traits>();
+    });
+
+    if(!table_status)
+        return table_status;
+
+    symbol_names = elf_sections.get_string_table(sections.links[symbol_index]);
+    return table_status;
+}
+
+template<typename Traits>
+bool ElfHashTable::is_symbol_named(uint32_t index, std::string_view name, struct ElfSymbolTable::Symbol &symbol)
+{
+    const struct ElfSection::SectionTable &sections = elf_sections.get_sections();
+    uint64_t entry_size = sections.entry_sizes[symbol_index];
+
+    if(entry_size < Traits::symbol_size || index >= sections.sizes[symbol_index] / entry_size)
+        return false;
+
+    /* Only this one entry gets read (in lazy mode). */
+    ElfResult<const uint8_t *> loaded = elf_sections.get_decoder()->ELF_data_at(sections.offsets[symbol_index] + index * entry_size, Traits::symbol_size);
+    if(!loaded)
+        return false;
+
+    const auto entry = Traits::template overlay<typename Traits::Symbol>(*loaded);
+
+    if(symbol_names.get_string(Traits::get(entry.st_name)) != name)
+        return false;
+
+    symbol.st_name = Traits::get(entry.st_name);
+    symbol.st_info = entry.st_info;
+    symbol.st_other = entry.st_other;
+    symbol.st_section_index = Traits::get(entry.st_shndx);
+    symbol.st_value = Traits::get(entry.st_value);
+    symbol.st_size = Traits::get(entry.st_size);
+
+    return true;
+}
+
+/* `.gnu.hash`: a 16 byte header, the bloom filter (words of the class's size), the buckets, and
+ * one hash per symbol from `symbol_offset` on, with the lowest bit set on the last one of each chain.
+ * */
+template<typename Traits>
+uint32_t ElfHashTable::find_gnu_symbol(std::string_view name, struct ElfSymbolTable::Symbol &symbol)
+{
+    using Word = typename Traits::Word;
+    constexpr uint32_t word_bits = sizeof(Word) * 8;
+
+    uint32_t hash = gnu_hash(name);
+
+    /* Both of the name's bits have to be set, otherwise the name is not in the table. */
+    Word bloom_word = bloom.read<Word, Traits::order>((uint64_t) ((hash / word_bits) % bloom_amnt) * sizeof(Word));
+    Word bloom_mask = ((Word) 1 << (hash % word_bits)) | ((Word) 1 << ((hash >> bloom_shift) % word_bits));
+
+    if((bloom_word & bloom_mask) != bloom_mask)
+        return ELF_HASH_NOT_FOUND;
+
+    uint32_t index = buckets.read<uint32_t, Traits::order>((uint64_t) (hash % bucket_amnt) * sizeof(uint32_t));
+    if(index < symbol_offset)
+        return ELF_HASH_NOT_FOUND;
+
+    for(; index - symbol_offset < chain_amnt; index++)
+    {
+        uint32_t chain_hash = chains.read<uint32_t, Traits::order>((uint64_t) (index - symbol_offset) * sizeof(uint32_t));
+
+        /* Only the names of symbols whose hash matches get compared. */
+        if((chain_hash | 1) == (hash | 1) && is_symbol_named<Traits>(index, name, symbol))
+            return index;
+
+        if(chain_hash & 1)
+            break;
+    }
+
+    return ELF_HASH_NOT_FOUND;
+}
+
+/* `.hash`: the amount of buckets and of chain entries, the buckets, then the chains. */
+template<typename Traits>
+uint32_t ElfHashTable::find_sysv_symbol(std::string_view name, struct ElfSymbolTable::Symbol &symbol)
+{
+    uint32_t index = buckets.read<uint32_t, Traits::order>((uint64_t) (sysv_hash(name) % bucket_amnt) * sizeof(uint32_t));
+
+    /* Every step is bounded by `chain_amnt`, so a looping chain cannot hang the lookup. */
+    for(uint32_t steps = 0; index != ELF_HASH_NOT_FOUND && index < chain_amnt && steps < chain_amnt; steps++)
+    {
+        if(is_symbol_named<Traits>(index, name, symbol))
+            return index;
+
+        index = chains.read<uint32_t, Traits::order>((uint64_t) index * sizeof(uint32_t));
+    }
+
+    return ELF_HASH_NOT_FOUND;
+}
+
+uint32_t ElfHashTable::find_symbol(std::string_view name, struct ElfSymbolTable::Symbol &symbol)
+{
+    if(!load_table() || !is_present())
+        return ELF_HASH_NOT_FOUND;
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    return ELF_dispatch(header.ELF_type, header.ELF_endianess, [&] <typename Traits> () {
+        if(hash_type == SectionTypes::SHT_GNU_HASH)
+            return find_gnu_symbol<Traits>(name, symbol);
+
+        return find_sysv_symbol<Traits>(name, symbol);
+    });
+}
@@ -1,214 +1,181 @@
 #include <elf_header.hpp>
 using namespace elf_header;
 
-void ElfHeader::ELF_get_data(uint8_t length, ELF_parts part, uint8_t &dest)
+template<typename Traits>
+void ElfHeader::ELF_decode_header(const uint8_t *raw, struct ELF_header &header)
 {
-	if(!(part == ELF_parts::ELF_Header))
-		return;
+    /* One copy for the whole header. */
+    const auto file_header = Traits::template overlay<typename Traits::Header>(raw);
+
+    /* The magic number is always compared as it reads in the file (`0x7F`, `E`, `L`, `F`). */
+    header.ELF_magic = ELF_read_value<uint32_t, std::endian::big>(file_header.e_ident);
+    header.ELF_type = file_header.e_ident[4];
+    header.ELF_endianess = file_header.e_ident[5];
+    header.ELF_version = file_header.e_ident[6];
+    memcpy(header.ELF_padding, &file_header.e_ident[7], sizeof(header.ELF_padding));
+
+    /* Everything after the first 16 bytes is stored in the byte order of the file. */
+    header.ELF_file_type = Traits::get(file_header.e_type);
+    header.ELF_machine_type = Traits::get(file_header.e_machine);
+    header.ELF_version2 = Traits::get(file_header.e_version);
+    header.ELF_entry = Traits::get(file_header.e_entry);
+    header.ELF_PH_offset = Traits::get(file_header.e_phoff);
+    header.ELF_SH_offset = Traits::get(file_header.e_shoff);
+    header.ELF_flags = Traits::get(file_header.e_flags);
+    header.ELF_hsize = Traits::get(file_header.e_ehsize);
+    header.ELF_PH_entry_size = Traits::get(file_header.e_phentsize);
+    header.ELF_PH_entry_amnt = Traits::get(file_header.e_phnum);
+    header.ELF_SH_size = Traits::get(file_header.e_shentsize);
+    header.ELF_SH_entry_amnt = Traits::get(file_header.e_shnum);
+    header.ELF_SH_str_index = Traits::get(file_header.e_shstrndx);
+}
 
-	/* The method, per this given class, does not read memory into a structure.
-	* Always read at least one byte.
-	* */
-	if(length == 0)
-		length = 1;
+template void ElfHeader::ELF_decode_header<Elf32LE>(const uint8_t *raw, struct ELF_header &header);
+template void ElfHeader::ELF_decode_header<Elf32BE>(const uint8_t *raw, struct ELF_header &header);
+template void ElfHeader::ELF_decode_header<Elf64LE>(const uint8_t *raw, struct ELF_header &header);
+template void ElfHeader::ELF_decode_header<Elf64BE>(const uint8_t *raw, struct ELF_header &header);
 
-	/* Read in the data. */
-	length = edecoder->ELF_read_binary(length, &dest, *edecoder->pholder);
+/* The first 16 bytes decide how the rest of the file gets decoded, so they are checked first. */
+ElfStatus ElfHeader::ELF_validate_ident(const uint8_t *ident)
+{
+    /* The magic number, a class and byte order we know, and the only version of ELF there is. */
+    if(ELF_read_value<uint32_t, std::endian::big>(ident) != ELF_MAGIC_NUMBER
+        || (ident[4] != (uint8_t) ELF_types::ELF32 && ident[4] != (uint8_t) ELF_types::ELF64)
+        || (ident[5] != (uint8_t) ELF_endianess::LittleE && ident[5] != (uint8_t) ELF_endianess::BigE)
+        || ident[6] != (uint8_t) ELF_CURRENT_VERSION)
+        return ELF_errors::Invalid_ELF_Ident;
+
+    return ElfStatus();
 }
 
-//ElfHeader::ELF_header &ElfHeader::get_elf_header()
-void ElfHeader::get_elf_header()
+ElfStatus ElfHeader::ELF_validate_header(struct ELF_header &header)
 {
-    uint8_t *read_in_data = nullptr;
-
-    const auto check_read_in_data = [&read_in_data] (uint8_t new_size)
-    {
-        if(read_in_data)
-            delete read_in_data;
-        
-        read_in_data = new uint8_t[new_size];
-    };
-
-    const auto get_single_byte = [&read_in_data, &check_read_in_data, this] ()
-    {
-        check_read_in_data(1);
-
-        ELF_get_data(1, ELF_parts::ELF_Header, *read_in_data);
-    };
-
-    const auto get_two_bytes = [&read_in_data, &check_read_in_data, this] ()
-    {
-        check_read_in_data(2);
-
-        ELF_get_data(2, ELF_parts::ELF_Header, *read_in_data);
-    };
-
-    const auto get_four_bytes = [&read_in_data, &check_read_in_data, this] ()
-    {
-        check_read_in_data(4);
-
-        ELF_get_data(4, ELF_parts::ELF_Header, *read_in_data);
-    };
-
-    {
-        /* Magic Number. */
-        get_four_bytes();
-        elf_header->ELF_magic = edecoder->make_into_complete_value<uint32_t> (strlen((const char *)read_in_data), read_in_data);
-        edecoder->check_data<uint32_t> (elf_header->ELF_magic, ELF_MAGIC_NUMBER);
-    }
-
-    {
-        /* ELF type (32-bit or 64-bit). */
-        get_single_byte();
-        elf_header->ELF_type = read_in_data[0];
-        ELF_ASSERT(elf_header->ELF_type != (uint8_t) ELF_types::Invalid,
-           "\nInvalid ELF type. The value at byte 5 should be 0x01 for 32-bit or 0x02 for 64-bit.\n")
-
-        /* ELF endianess. */
-        get_single_byte();
-        elf_header->ELF_endianess = read_in_data[0];
-        ELF_ASSERT(elf_header->ELF_endianess != (uint8_t) ELF_endianess::InvalidE,
-            "\nInvalid ELF endianess type. The value at byte 6 should be 0x01 for Little Endian or 0x02 for Big Endian.\n")
-
-        /* ELF version. */
-        get_single_byte();
-        elf_header->ELF_version = read_in_data[0];
-        ELF_ASSERT(elf_header->ELF_version == (uint8_t) ELF_CURRENT_VERSION,
-            "\nInvalid ELF version. The value at byte 7 should be 0x01, as that is the only version of ELF supported.\n")
-
-        /* 9 bytes of padding. */
-        get_four_bytes();
-        get_four_bytes();
-        get_single_byte();
-    }
-
-    {
-        /* ELF file type. */
-        get_two_bytes();
-        elf_header->ELF_file_type = (edecoder->make_into_complete_value<uint16_t> (2, read_in_data) >> 8) & 0xFF;
-
-        /* ELF machine type. */
-        get_two_bytes();
-        elf_header->ELF_machine_type = (edecoder->make_into_complete_value<uint16_t> (2, read_in_data) >> 8) & 0xFF;
-    }
-
-    {
-        /* Get the ELF version, again. */
-        get_four_bytes();
-        elf_header->ELF_version2 = (edecoder->make_into_complete_value<uint32_t> (4, read_in_data) >> 24) & 0xFF;
-        edecoder->check_data<uint32_t> (elf_header->ELF_version2, (uint32_t) ELF_CURRENT_VERSION);
-
-        /* Get the entry point. */
-        get_four_bytes();
-        elf_header->ELF_entry = revert_value<uint32_t> (edecoder->make_into_complete_value<uint32_t> (4, read_in_data));
-        
-        /* Get the Program Header offset. */
-        get_four_bytes();
-        elf_header->ELF_PH_offset = revert_value<uint32_t> (edecoder->make_into_complete_value<uint32_t> (4, read_in_data));
-
-        /* Get the Section Header offset. */
-        get_four_bytes();
-        elf_header->ELF_SH_offset = revert_value<uint32_t> (edecoder->make_into_complete_value<uint32_t> (4, read_in_data));
-
-        /* Get ELF flags. */
-        get_four_bytes();
-        elf_header->ELF_flags = revert_value<uint32_t> (edecoder->make_into_complete_value<uint32_t> (4, read_in_data));
-
-        delete read_in_data;
-    }
-
-    {
-        /* Get ELF Header Size (in bytes). */
-        get_two_bytes();
-        elf_header->ELF_hsize = revert_value<uint16_t> (edecoder->make_into_complete_value<uint16_t> (2, read_in_data));
-        edecoder->check_data<uint16_t> (elf_header->ELF_hsize, ELF_HEADER_SIZE);
-
-        /* Get Program Header entry size. */
-        get_two_bytes();
-        elf_header->ELF_PH_entry_size = revert_value<uint16_t> (edecoder->make_into_complete_value<uint16_t> (2, read_in_data));
-        
-        /* The program header size should always be `0x20`(32-bytes).
-         * If the value is not `0x20` or `0x0`, error.
-         * */
-        ELF_ASSERT(elf_header->ELF_PH_entry_size == ELF_PROGRAM_HEADER_SIZE || elf_header->ELF_PH_entry_size == 0,
-            "\nInvalid ELF program header size. Must be `0x20` or `0x0`.\n")
-
-        /* Get the amount of Program Header entries. */
-        get_two_bytes();
-        elf_header->ELF_PH_entry_amnt = revert_value<uint16_t> (edecoder->make_into_complete_value<uint16_t> (2, read_in_data));
-
-        /* Get the Section Header size. */
-        get_two_bytes();
-        elf_header->ELF_SH_size = revert_value<uint16_t> (edecoder->make_into_complete_value<uint16_t> (2, read_in_data));
-        edecoder->check_data<uint16_t> (elf_header->ELF_SH_size, ELF_SECTION_HEADER_SIZE);
-
-        /* Get the amount of Section Header entries. */
-        get_two_bytes();
-        elf_header->ELF_SH_entry_amnt = revert_value<uint16_t> (edecoder->make_into_complete_value<uint16_t> (2, read_in_data));
-
-        /* Get the index of the entry associated with the section name string table. */
-        get_two_bytes();
-        elf_header->ELF_SH_str_index = revert_value<uint16_t> (edecoder->make_into_complete_value<uint16_t> (2, read_in_data));
-
-        delete read_in_data;
-    }
+    bool is_64_bit = header.ELF_type == (uint8_t) ELF_types::ELF64;
+    uint16_t header_size = is_64_bit ? Elf64LE::header_size : Elf32LE::header_size;
+    uint16_t program_header_size = is_64_bit ? Elf64LE::program_header_size : Elf32LE::program_header_size;
+    uint16_t section_header_size = is_64_bit ? Elf64LE::section_header_size : Elf32LE::section_header_size;
+
+    if(header.ELF_version2 != ELF_CURRENT_VERSION || header.ELF_hsize != header_size)
+        return ELF_errors::Invalid_ELF_Header;
+
+    /* The program header size should always be `0x20`(32-bytes) for 32-bit and `0x38`(56-bytes) for 64-bit.
+     * If the value is not that or `0x0`, error.
+     * */
+    if(header.ELF_PH_entry_size != program_header_size && header.ELF_PH_entry_size != 0)
+        return ELF_errors::Invalid_ELF_Header;
+
+    /* Same for the section header size, though it can only be zero if there are no sections. */
+    if(header.ELF_SH_size != section_header_size && !(header.ELF_SH_size == 0 && header.ELF_SH_offset == 0))
+        return ELF_errors::Invalid_ELF_Header;
 
     /* Last check.
      * If there is a designated Program Header offset, but the Program Header size
-     * is zero, error.
+     * is zero (or the other way around), error.
      * */
-    if((elf_header->ELF_PH_offset == 0 && !(elf_header->ELF_PH_entry_size == 0)) ||
-       (!(elf_header->ELF_PH_offset ==0) && elf_header->ELF_PH_entry_size == 0))
-        ELF_LOG(true,
-            "\nThere was an error that occurred with the data received for the ELFs Program Header:\n\tProgram Header Offset: %X\n\tProgram Header Size: %X",
-            elf_header->ELF_PH_offset, elf_header->ELF_PH_entry_size)
+    if((header.ELF_PH_offset == 0) != (header.ELF_PH_entry_size == 0))
+        return ELF_errors::Invalid_ELF_Header;
+
+    return ElfStatus();
+}
 
-    if(read_in_data)
-        delete read_in_data;
-    read_in_data = nullptr;
+//ElfHeader::ELF_header &ElfHeader::get_elf_header()
+ElfStatus ElfHeader::get_elf_header()
+{
+    /* The header is only decoded the first time it is asked for. */
+    if(header_decoded) return header_status;
+    header_decoded = true;
+
+    /* In lazy mode, this is the only read needed for the whole header. */
+    edecoder->ELF_load_range(0, ELF_MAX_HEADER_SIZE);
+
+    ElfResult<const uint8_t *> ident = edecoder->ELF_data_at(0, ELF_IDENT_SIZE);
+    if(!ident)
+        return header_status = ident.error();
+
+    header_status = ELF_validate_ident(*ident);
+    if(!header_status)
+        return header_status;
+
+    /* The class and byte order are decided here, once; `ELF_data_at` makes sure the file is big enough to hold the header. */
+    header_status = ELF_dispatch((*ident)[4], (*ident)[5], [this] <typename Traits> () -> ElfStatus {
+        ElfResult<const uint8_t *> raw = edecoder->ELF_data_at(0, Traits::header_size);
+        if(!raw)
+            return raw.error();
+
+        ELF_decode_header<Traits>(*raw, *elf_header);
+        return ElfStatus();
+    });
+    if(!header_status)
+        return header_status;
+
+    return header_status = ELF_validate_header(*elf_header);
 
     //return *elf_header;
 }
 
-void ElfHeader::print_elf_header()
+void ElfHeader::print_elf_header(ElfOutput &out)
 {
-    printf("\nDecoding %s:\n", &efilename);
-    printf("\n\tELF Signature:             \t       \e[0;92m%X\e[0;97m\n\tELF Bit Type:              \t       \e[0;92m0x%X\e[0;97m (\e[0;95m%s\e[0;97m)\n\tELF Endianess:             \t       \e[0;92m0x%X\e[0;97m (\e[0;95m%s\e[0;97m)\n\t",
-        elf_header->ELF_magic,
-        elf_header->ELF_type,
-        get_ELF_type_name((ELF_types) elf_header->ELF_type),
-        elf_header->ELF_endianess,
-        get_ELF_endianess_name((ELF_endianess) elf_header->ELF_endianess));
-    
-    printf("ELF Version:               \t       \e[0;92m0x%X\e[0;97m\n\tELF File Type:             \t       \e[0;92m0x%X\e[0;97m (\e[0;95m%s\e[0;97m)\n\tELF Machine Type:          \t       \e[0;92m0x%X\e[0;97m (\e[0;95m%s\e[0;97m)\n\t",
-        elf_header->ELF_version,
-        elf_header->ELF_file_type,
-        get_ELF_file_type_name((ELF_file_types) elf_header->ELF_file_type),
-        elf_header->ELF_machine_type,
-        get_ELF_machine_type_name((ELF_machine_types) elf_header->ELF_machine_type));
-    
-    printf("ELF Entry:                 \t       \e[0;92m0x%X\e[0;97m\n\tELF Program Header Offset: \t       \e[0;92m0x%X\e[0;97m\n\t",
-        elf_header->ELF_entry,
-        elf_header->ELF_PH_offset);
-    
-    printf("ELF Section Header Offset: \t       \e[0;92m0x%X\e[0;97m\n\tELF Flags:                 \t       \e[0;92m0x%X\e[0;97m\n\tELF Header Size:           \t       \e[0;92m0x%X\e[0;97m (\e[0;95m%d bytes\e[0;97m)\n\t",
-        elf_header->ELF_SH_offset,
-        elf_header->ELF_flags,
-        elf_header->ELF_hsize,
-        elf_header->ELF_hsize);
-    
-    printf("ELF Program Header Entry Size:         \e[0;92m0x%X\e[0;97m (\e[0;95m%d bytes\e[0;97m)\n\tELF Program Header Entry Amount:       \e[0;92m0x%X\e[0;97m (\e[0;95m%d entries\e[0;97m)\n\t",
-        elf_header->ELF_PH_entry_size,
-        elf_header->ELF_PH_entry_size,
-        elf_header->ELF_PH_entry_amnt,
-        elf_header->ELF_PH_entry_amnt);
-    
-    printf("ELF Section Header Size:               \e[0;92m0x%X\e[0;97m (\e[0;95m%d bytes\e[0;97m)\n\tELF Section Header Entry Amount:       \e[0;92m0x%X\e[0;97m (\e[0;95m%d entries\e[0;97m)\n\t",
-        elf_header->ELF_SH_size,
-        elf_header->ELF_SH_size,
-        elf_header->ELF_SH_entry_amnt,
-        elf_header->ELF_SH_entry_amnt);
-    
-    printf("ELF Section Header String Table Index: \e[0;92m0x%X\e[0;97m\n\n",
-        elf_header->ELF_SH_str_index);
-}
\ No newline at end of file
+    get_elf_header();
+
+    out.text("\nDecoding ").text((const char *) efilename).text(":\n");
+    out.text("\n\tELF Signature:             \t       ").color(ELF_COLOR_VALUE).hex(elf_header->ELF_magic).color(ELF_COLOR_RESET)
+        .text("\n\tELF Bit Type:              \t       ").value_hex(elf_header->ELF_type)
+        .text(" (").description((const char *) get_ELF_type_name((ELF_types) elf_header->ELF_type)).text(")")
+        .text("\n\tELF Endianess:             \t       ").value_hex(elf_header->ELF_endianess)
+        .text(" (").description((const char *) get_ELF_endianess_name((ELF_endianess) elf_header->ELF_endianess)).text(")\n\t");
+
+    out.text("ELF Version:               \t       ").value_hex(elf_header->ELF_version)
+        .text("\n\tELF File Type:             \t       ").value_hex(elf_header->ELF_file_type)
+        .text(" (").description((const char *) get_ELF_file_type_name((ELF_file_types) elf_header->ELF_file_type)).text(")")
+        .text("\n\tELF Machine Type:          \t       ").value_hex(elf_header->ELF_machine_type)
+        .text(" (").description((const char *) get_ELF_machine_type_name((ELF_machine_types) elf_header->ELF_machine_type)).text(")\n\t");
+
+    out.text("ELF Entry:                 \t       ").value_hex(elf_header->ELF_entry)
+        .text("\n\tELF Program Header Offset: \t       ").value_hex(elf_header->ELF_PH_offset).text("\n\t");
+
+    out.text("ELF Section Header Offset: \t       ").value_hex(elf_header->ELF_SH_offset)
+        .text("\n\tELF Flags:                 \t       ").value_hex(elf_header->ELF_flags)
+        .text("\n\tELF Header Size:           \t       ").value_hex(elf_header->ELF_hsize)
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(elf_header->ELF_hsize).text(" bytes").color(ELF_COLOR_RESET).text(")\n\t");
+
+    out.text("ELF Program Header Entry Size:         ").value_hex(elf_header->ELF_PH_entry_size)
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(elf_header->ELF_PH_entry_size).text(" bytes").color(ELF_COLOR_RESET).text(")")
+        .text("\n\tELF Program Header Entry Amount:       ").value_hex(elf_header->ELF_PH_entry_amnt)
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(elf_header->ELF_PH_entry_amnt).text(" entries").color(ELF_COLOR_RESET).text(")\n\t");
+
+    out.text("ELF Section Header Size:               ").value_hex(elf_header->ELF_SH_size)
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(elf_header->ELF_SH_size).text(" bytes").color(ELF_COLOR_RESET).text(")")
+        .text("\n\tELF Section Header Entry Amount:       ").value_hex(elf_header->ELF_SH_entry_amnt)
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(elf_header->ELF_SH_entry_amnt).text(" entries").color(ELF_COLOR_RESET).text(")\n\t");
+
+    out.text("ELF Section Header String Table Index: ").value_hex(elf_header->ELF_SH_str_index).text("\n\n");
+}
+
+/* Field names follow the ELF specification (`e_phoff` -> `phoff`...); every value is a plain number. */
+void ElfHeader::print_elf_header_json(ElfOutput &out)
+{
+    get_elf_header();
+
+    out.json_key("header").character('{')
+        .json_key("magic").decimal(elf_header->ELF_magic).character(',')
+        .json_key("class").decimal(elf_header->ELF_type).character(',')
+        .json_key("class_name").json_string((const char *) get_ELF_type_name((ELF_types) elf_header->ELF_type)).character(',')
+        .json_key("data").decimal(elf_header->ELF_endianess).character(',')
+        .json_key("data_name").json_string((const char *) get_ELF_endianess_name((ELF_endianess) elf_header->ELF_endianess)).character(',')
+        .json_key("ident_version").decimal(elf_header->ELF_version).character(',')
+        .json_key("type").decimal(elf_header->ELF_file_type).character(',')
+        .json_key("type_name").json_string((const char *) get_ELF_file_type_name((ELF_file_types) elf_header->ELF_file_type)).character(',')
+        .json_key("machine").decimal(elf_header->ELF_machine_type).character(',')
+        .json_key("machine_name").json_string((const char *) get_ELF_machine_type_name((ELF_machine_types) elf_header->ELF_machine_type)).character(',')
+        .json_key("version").decimal(elf_header->ELF_version2).character(',')
+        .json_key("entry").decimal(elf_header->ELF_entry).character(',')
+        .json_key("phoff").decimal(elf_header->ELF_PH_offset).character(',')
+        .json_key("shoff").decimal(elf_header->ELF_SH_offset).character(',')
+        .json_key("flags").decimal(elf_header->ELF_flags).character(',')
+        .json_key("ehsize").decimal(elf_header->ELF_hsize).character(',')
+        .json_key("phentsize").decimal(elf_header->ELF_PH_entry_size).character(',')
+        .json_key("phnum").decimal(elf_header->ELF_PH_entry_amnt).character(',')
+        .json_key("shentsize").decimal(elf_header->ELF_SH_size).character(',')
+        .json_key("shnum").decimal(elf_header->ELF_SH_entry_amnt).character(',')
+        .json_key("shstrndx").decimal(elf_header->ELF_SH_str_index).character('}');
+}
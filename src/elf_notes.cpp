@@ -0,0 +1,293 @@
+#include <elf_notes.hpp>
+using namespace elf_notes;
+
+template<typename Traits>
+void ElfNotes::decode_notes(const ElfSpan &data, uint64_t align)
+{
+    /* Only 4 and 8 byte alignments are in use; anything else is treated as 4. */
+    align = align == 8 ? 8 : 4;
+
+    /* The padding after the last note can take `offset` past the end, which `fits` also catches. */
+    for(uint64_t offset = 0; data.fits(offset, ELF_NOTE_HEADER_SIZE);)
+    {
+        uint64_t name_size = data.read<uint32_t, Traits::order>(offset);
+        uint64_t description_size = data.read<uint32_t, Traits::order>(offset + 4);
+        uint32_t type = data.read<uint32_t, Traits::order>(offset + 8);
+        uint64_t name = offset + ELF_NOTE_HEADER_SIZE;
+        uint64_t description = (name + name_size + align - 1) & ~(align - 1);
+
+        /* All in 64-bit, from 32-bit sizes, so none of this can overflow. */
+        if(!data.fits(description, description_size))
+            break;
+
+        /* The name includes its NUL. */
+        std::string_view owner((const char *) data.at(name), name_size);
+        if(!owner.empty() && owner.back() == '\0')
+            owner.remove_suffix(1);
+
+        notes.push_back({ owner, type, (uint32_t) description_size, data.at(description) });
+        offset = (description + description_size + align - 1) & ~(align - 1);
+    }
+}
+
+ElfStatus ElfNotes::get_notes()
+{
+    /* The notes are only read the first time they are asked for. */
+    if(notes_decoded) return notes_status;
+    notes_decoded = true;
+
+    /* Notes are found through the section header table, or the program header table without one. */
+    notes_status = elf_sections.get_section_header_table();
+    if(notes_status)
+        notes_status = elf_sections.get_program_header_table();
+    if(!notes_status)
+        return notes_status;
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    notes_status = ELF_dispatch(header.ELF_type, header.ELF_endianess, [this] <typename Traits> () -> ElfStatus {
+        ElfDecoder *decoder = elf_sections.get_decoder();
+        const struct ElfSection::SectionTable &sections = elf_sections.get_sections();
+        uint32_t section_amnt = elf_sections.get_section_amnt();
+
+        for(uint32_t i = 0; i < section_amnt; i++)
+        {
+            if(sections.types[i] != (uint32_t) SectionTypes::SHT_NOTE || sections.sizes[i] == 0)
+                continue;
+
+            ElfResult<ElfSpan> data = decoder->ELF_table_at(sections.offsets[i], sections.sizes[i], 1);
+            if(!data)
+                return data.error();
+
+            decode_notes<Traits>(*data, sections.alignments[i]);
+        }
+
+        /* Files stripped of their section headers still have the notes that get loaded. */
+        if(section_amnt > 0)
+            return ElfStatus();
+
+        for(uint32_t i = 0; i < elf_sections.get_program_header_amnt(); i++)
+        {
+            const struct ElfProgramHeader::ProgramHeader &segment = elf_sections.get_program_header(i);
+
+            if(segment.p_type != (uint32_t) SegmentTypes::ST_NOTE || segment.p_size == 0)
+                continue;
+
+            ElfResult<ElfSpan> data = decoder->ELF_table_at(segment.p_offset, segment.p_size, 1);
+            if(!data)
+                return data.error();
+
+            decode_notes<Traits>(*data, segment.p_align);
+        }
+
+        return ElfStatus();
+    });
+
+    /* Notes pointing into a part of the file that is not there would be left dangling. */
+    if(!notes_status)
+        notes.clear();
+
+    return notes_status;
+}
+
+const struct ElfNotes::Note *ElfNotes::find_note(std::string_view owner, uint32_t type)
+{
+    get_notes();
+
+    for(const auto &note : notes)
+    {
+        if(note.type == type && note.owner == owner)
+            return &note;
+    }
+
+    return nullptr;
+}
+
+std::basic_string_view<uint8_t> ElfNotes::get_build_id()
+{
+    const struct Note *note = find_note("GNU", (uint32_t) GnuNoteTypes::NT_GNU_BUILD_ID);
+
+    if(!note)
+        return std::basic_string_view<uint8_t>();
+
+    return std::basic_string_view<uint8_t>(note->description, note->description_size);
+}
+
+bool ElfNotes::get_abi_tag(struct AbiTag &tag)
+{
+    const struct Note *note = find_note("GNU", (uint32_t) GnuNoteTypes::NT_GNU_ABI_TAG);
+
+    return note && get_abi_tag(*note, tag);
+}
+
+bool ElfNotes::get_abi_tag(const struct Note &note, struct AbiTag &tag)
+{
+    if(note.description_size < 4 * sizeof(uint32_t))
+        return false;
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    ELF_dispatch(header.ELF_type, header.ELF_endianess, [&] <typename Traits> () {
+        tag.os = ELF_read_value<uint32_t, Traits::order>(note.description);
+        tag.major = ELF_read_value<uint32_t, Traits::order>(note.description + 4);
+        tag.minor = ELF_read_value<uint32_t, Traits::order>(note.description + 8);
+        tag.patch = ELF_read_value<uint32_t, Traits::order>(note.description + 12);
+    });
+
+    return true;
+}
+
+/* Properties are a type, a data size and the data, padded to the size of an address. */
+template<typename Traits>
+void ElfNotes::decode_properties(const struct Note &note, struct Properties &properties)
+{
+    constexpr uint64_t align = sizeof(typename Traits::Word);
+    const ElfSpan description(note.description, note.description_size);
+
+    /* The padding after the last property can take `offset` past the end, which `fits` also catches. */
+    for(uint64_t offset = 0; description.fits(offset, 8);)
+    {
+        uint32_t type = description.read<uint32_t, Traits::order>(offset);
+        uint64_t data_size = description.read<uint32_t, Traits::order>(offset + 4);
+        ElfResult<ElfSpan> data = description.subspan(offset + 8, data_size);
+
+        if(!data)
+            break;
+
+        if(data_size >= sizeof(uint32_t))
+        {
+            if(type == ELF_PROPERTY_X86_FEATURE_1)
+                properties.x86_features = data->read<uint32_t, Traits::order>(0);
+            else if(type == ELF_PROPERTY_X86_ISA_1_NEEDED)
+                properties.x86_isa_needed = data->read<uint32_t, Traits::order>(0);
+            else if(type == ELF_PROPERTY_AARCH64_FEATURE_1)
+                properties.aarch64_features = data->read<uint32_t, Traits::order>(0);
+            else if(type == ELF_PROPERTY_STACK_SIZE && data_size >= sizeof(typename Traits::Word))
+                properties.stack_size = data->read<typename Traits::Word, Traits::order>(0);
+        }
+
+        offset += 8 + ((data_size + align - 1) & ~(align - 1));
+    }
+}
+
+bool ElfNotes::get_properties(struct Properties &properties)
+{
+    const struct Note *note = find_note("GNU", (uint32_t) GnuNoteTypes::NT_GNU_PROPERTY_TYPE_0);
+
+    properties = {};
+    if(!note)
+        return false;
+
+    get_properties(*note, properties);
+    return true;
+}
+
+void ElfNotes::get_properties(const struct Note &note, struct Properties &properties)
+{
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    properties = {};
+    ELF_dispatch(header.ELF_type, header.ELF_endianess, [&] <typename Traits> () {
+        decode_properties<Traits>(note, properties);
+    });
+}
+
+void ElfNotes::print_notes(ElfOutput &out)
+{
+    get_notes();
+
+    if(notes.empty())
+        return;
+
+    out.text("\tNotes (").color(ELF_COLOR_DESCRIPTION).decimal(notes.size()).text(" entries").color(ELF_COLOR_RESET).text("):\n");
+
+    for(const auto &note : notes)
+    {
+        out.text("\t\tOwner: ").description(note.owner)
+            .text("  Type: ").value_hex(note.type).text(" (").description((const char *) get_note_type_name(note.owner, note.type)).text(")")
+            .text("  Size: ").color(ELF_COLOR_VALUE).decimal(note.description_size).color(ELF_COLOR_RESET);
+
+        if(note.owner == "GNU" && note.type == (uint32_t) GnuNoteTypes::NT_GNU_BUILD_ID)
+        {
+            out.text("  Build ID: ").color(ELF_COLOR_VALUE);
+            print_build_id(note.description, note.description_size, out);
+            out.color(ELF_COLOR_RESET);
+        }
+
+        struct AbiTag tag;
+        if(note.owner == "GNU" && note.type == (uint32_t) GnuNoteTypes::NT_GNU_ABI_TAG && get_abi_tag(note, tag))
+        {
+            out.text("  OS: ").description((const char *) get_abi_os_name(tag.os))
+                .text("  Kernel: ").color(ELF_COLOR_VALUE).decimal(tag.major).character('.').decimal(tag.minor).character('.').decimal(tag.patch).color(ELF_COLOR_RESET);
+        }
+
+        if(note.owner == "GNU" && note.type == (uint32_t) GnuNoteTypes::NT_GNU_PROPERTY_TYPE_0)
+        {
+            struct Properties properties;
+            get_properties(note, properties);
+
+            if(properties.x86_features)
+                out.text("  x86 Features: ").value_hex(properties.x86_features);
+            if(properties.x86_isa_needed)
+                out.text("  x86 ISA Needed: ").value_hex(properties.x86_isa_needed);
+            if(properties.aarch64_features)
+                out.text("  AArch64 Features: ").value_hex(properties.aarch64_features);
+            if(properties.stack_size)
+                out.text("  Stack Size: ").value_hex(properties.stack_size);
+        }
+
+        out.text("\n");
+    }
+
+    out.text("\n");
+}
+
+void ElfNotes::print_notes_json(ElfOutput &out)
+{
+    get_notes();
+
+    out.json_key("notes").character('[');
+
+    for(uint32_t i = 0; i < notes.size(); i++)
+    {
+        const struct Note &note = notes[i];
+
+        if(i > 0)
+            out.character(',');
+
+        out.character('{')
+            .json_key("owner").json_string(note.owner).character(',')
+            .json_key("type").decimal(note.type).character(',')
+            .json_key("type_name").json_string((const char *) get_note_type_name(note.owner, note.type)).character(',')
+            .json_key("size").decimal(note.description_size);
+
+        if(note.owner == "GNU" && note.type == (uint32_t) GnuNoteTypes::NT_GNU_BUILD_ID)
+        {
+            out.character(',').json_key("build_id").character('"');
+            print_build_id(note.description, note.description_size, out);
+            out.character('"');
+        }
+
+        struct AbiTag tag;
+        if(note.owner == "GNU" && note.type == (uint32_t) GnuNoteTypes::NT_GNU_ABI_TAG && get_abi_tag(note, tag))
+        {
+            out.character(',').json_key("os").decimal(tag.os).character(',')
+                .json_key("kernel").character('"').decimal(tag.major).character('.').decimal(tag.minor).character('.').decimal(tag.patch).character('"');
+        }
+
+        if(note.owner == "GNU" && note.type == (uint32_t) GnuNoteTypes::NT_GNU_PROPERTY_TYPE_0)
+        {
+            struct Properties properties;
+            get_properties(note, properties);
+
+            out.character(',').json_key("x86_features").decimal(properties.x86_features).character(',')
+                .json_key("x86_isa_needed").decimal(properties.x86_isa_needed).character(',')
+                .json_key("aarch64_features").decimal(properties.aarch64_features).character(',')
+                .json_key("stack_size").decimal(properties.stack_size);
+        }
+
+        out.character('}');
+    }
+
+    out.character(']');
+}
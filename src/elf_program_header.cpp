@@ -1,102 +1,136 @@
 #include <elf_program_header.hpp>
 using namespace elf_program_header;
 
-void ElfProgramHeader::ELF_get_data(uint8_t length, ELF_parts part, uint8_t &dest)
+template<typename Traits>
+ElfStatus ElfProgramHeader::decode_program_header_table()
 {
-    if(!(part == ELF_parts::ELF_PHeader))
-        return;
-    
-    if(length == 0)
-        length = 1;
-    
-    length = edecoder->ELF_read_binary(length, &dest, *edecoder->pholder);
-}
-
-void ElfProgramHeader::get_program_header_table()
-{
-    
-    uint8_t *read_in_data = nullptr;
+    pheader_amnt = elf_header->ELF_PH_entry_amnt;
 
-    const auto get_four_bytes = [&read_in_data, this] ()
-    {
-        if(read_in_data == nullptr)
-            read_in_data = new uint8_t[4];
-        
-        ELF_get_data(4, ELF_parts::ELF_PHeader, *read_in_data);
-    };
-
-    /*
-     * TODO: remove the argument `uint32_t &dest` and make it to where `make_comp`
-     *       returns the above code? That way, below, it looks like:
-     *       `pheader[index]->variable = make_comp();`
-     * 
-     * */
-    const auto make_comp = [&read_in_data, this] (uint32_t &dest)
+    /* With extended numbering, the real amount of entries is kept in section header 0. */
+    if(pheader_amnt == ELF_PH_EXTENDED_NUMBERING && elf_header->ELF_SH_offset != 0)
     {
-        dest = revert_value<uint32_t> (edecoder->make_into_complete_value<uint32_t> (4, read_in_data));
-    };
+        ElfResult<const uint8_t *> first = edecoder->ELF_data_at(elf_header->ELF_SH_offset, Traits::section_header_size);
+        if(!first)
+            return first.error();
 
-    reloop:
+        pheader_amnt = Traits::get(Traits::template overlay<typename Traits::SectionHeader>(*first).sh_info);
+    }
 
-    /* Segment Type. */
-    get_four_bytes();
-    make_comp(pheader[index]->p_type);
+    if(pheader_amnt == 0 || elf_header->ELF_PH_offset == 0)
+    {
+        pheader_amnt = 0;
+        return ElfStatus();
+    }
 
-    /* Program Header Offset (should be 0x34). */
-    get_four_bytes();
-    make_comp(pheader[index]->p_offset);
+    size_t entry_size = elf_header->ELF_PH_entry_size;
+    ElfResult<ElfSpan> table = edecoder->ELF_table_at(elf_header->ELF_PH_offset, pheader_amnt, entry_size);
+    if(!table)
+        return table.error();
 
-    /* Virtual/Physical Address. */
+    /* A 64-bit table in the host's byte order is already laid out like `ProgramHeader`. */
+    if constexpr(std::is_same<typename Traits::ProgramHeader, struct ELF64_raw_program_header>::value
+        && Traits::order == std::endian::native)
     {
-        get_four_bytes();
-        make_comp(pheader[index]->p_virtual_address);
-
-        get_four_bytes();
-        make_comp(pheader[index]->p_physical_address);
+        if((uintptr_t) table->data() % alignof(struct ProgramHeader) == 0)
+        {
+            pheader = (const struct ProgramHeader *) table->data();
+            return ElfStatus();
+        }
     }
 
-    /* Size (in bytes)/Memory size (in bytes) that the entries take up. */
-    {
-        get_four_bytes();
-        make_comp(pheader[index]->p_size);
+    /* The whole table in one piece, right after the header in the file's arena. */
+    struct ProgramHeader *pheader_storage = edecoder->ELF_get_arena().allocate<struct ProgramHeader>(pheader_amnt);
 
-        get_four_bytes();
-        make_comp(pheader[index]->p_memory_size);
+    for(uint32_t i = 0; i < pheader_amnt; i++)
+    {
+        const auto entry = Traits::template overlay<typename Traits::ProgramHeader>(table->entry(i, entry_size));
+        struct ProgramHeader &decoded = pheader_storage[i];
+
+        decoded.p_type = Traits::get(entry.p_type);
+        decoded.p_flags = Traits::get(entry.p_flags);
+        decoded.p_offset = Traits::get(entry.p_offset);
+        decoded.p_virtual_address = Traits::get(entry.p_vaddr);
+        decoded.p_physical_address = Traits::get(entry.p_paddr);
+        decoded.p_size = Traits::get(entry.p_filesz);
+        decoded.p_memory_size = Traits::get(entry.p_memsz);
+        decoded.p_align = Traits::get(entry.p_align);
     }
 
-    /* Flags. */
-    get_four_bytes();
-    make_comp(pheader[index]->p_flags);
+    pheader = pheader_storage;
+    return ElfStatus();
+}
+
+ElfStatus ElfProgramHeader::get_program_header_table()
+{
+    if(pheader_decoded) return pheader_status;
+    pheader_decoded = true;
 
-    /* Alignment. */
-    get_four_bytes();
-    make_comp(pheader[index]->p_align);
+    pheader_status = get_elf_header();
 
-    if(pheader[0]->p_type == (uint32_t) SegmentTypes::ST_NULL)
-    {
-        delete pheader[0];
-        delete pheader;
-        pheader = nullptr;
+    if(pheader_status)
+        pheader_status = ELF_dispatch(elf_header->ELF_type, elf_header->ELF_endianess, [this] <typename Traits> () {
+            return decode_program_header_table<Traits>();
+        });
 
-        goto end;
-    }
+    if(!pheader_status)
+        pheader_amnt = 0;
 
-    if(pheader[index]->p_type != (uint32_t) SegmentTypes::ST_NULL) goto reloop;
+    return pheader_status;
+}
 
-    end:
-    if(read_in_data) delete read_in_data;
-    read_in_data = nullptr;
+void ElfProgramHeader::print_elf_program_header_table(ElfOutput &out)
+{
+    get_program_header_table();
+
+    for(uint32_t i = 0; i < pheader_amnt; i++)
+    {
+        const struct ProgramHeader &entry = pheader[i];
+        const char flags[] = {
+            entry.p_flags & (uint32_t) SegmentFlags::SF_READ ? 'R' : '-',
+            entry.p_flags & (uint32_t) SegmentFlags::SF_WRITE ? 'W' : '-',
+            entry.p_flags & (uint32_t) SegmentFlags::SF_EXECUTE ? 'X' : '-'
+        };
+
+        out.text("\tProgram Header Entry #").decimal(i + 1).text(":\n");
+        out.text("\t\tEntry Type:         ").value_hex(entry.p_type)
+            .text(" (").description((const char *) get_entry_type_name((SegmentTypes) entry.p_type)).text(")\n");
+        out.text("\t\tOffset:             ").value_hex(entry.p_offset)
+            .text("\n\t\tVirtual Address:    ").value_hex(entry.p_virtual_address)
+            .text("\n\t\tPhysical Address:   ").value_hex(entry.p_physical_address).text("\n");
+        out.text("\t\tFile Size:          ").value_hex(entry.p_size)
+            .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(entry.p_size).text(" bytes").color(ELF_COLOR_RESET).text(")")
+            .text("\n\t\tMemory Size:        ").value_hex(entry.p_memory_size)
+            .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(entry.p_memory_size).text(" bytes").color(ELF_COLOR_RESET).text(")\n");
+        out.text("\t\tFlags:              ").value_hex(entry.p_flags)
+            .text(" (").description(std::string_view(flags, sizeof(flags))).text(")")
+            .text("\n\t\tAlignment:          ").value_hex(entry.p_align).text("\n\n");
+    }
 }
 
-void ElfProgramHeader::print_elf_program_header_table()
+void ElfProgramHeader::print_elf_program_header_table_json(ElfOutput &out)
 {
-    if(pheader)
+    get_program_header_table();
+
+    out.json_key("program_headers").character('[');
+
+    for(uint32_t i = 0; i < pheader_amnt; i++)
     {
-        for(uint16_t i = 0; i < index; i++)
-        {
-            printf("\tProgram Header Entry #%d:", i + 1);
-            printf("\n\t\tEntry Type: %X (%s)",
-                pheader[i]->p_type, get_entry_type_name((SegmentTypes) pheader[i]->p_type));
-        }
+        const struct ProgramHeader &entry = pheader[i];
+
+        if(i > 0)
+            out.character(',');
+
+        out.character('{')
+            .json_key("type").decimal(entry.p_type).character(',')
+            .json_key("type_name").json_string((const char *) get_entry_type_name((SegmentTypes) entry.p_type)).character(',')
+            .json_key("flags").decimal(entry.p_flags).character(',')
+            .json_key("offset").decimal(entry.p_offset).character(',')
+            .json_key("vaddr").decimal(entry.p_virtual_address).character(',')
+            .json_key("paddr").decimal(entry.p_physical_address).character(',')
+            .json_key("filesz").decimal(entry.p_size).character(',')
+            .json_key("memsz").decimal(entry.p_memory_size).character(',')
+            .json_key("align").decimal(entry.p_align).character('}');
     }
-}
\ No newline at end of file
+
+    out.character(']');
+}
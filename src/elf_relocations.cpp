@@ -0,0 +1,457 @@
+#include <elf_relocations.hpp>
+using namespace elf_relocations;
+
+ElfRelocations::ElfRelocations(ElfSection &sections)
+    : elf_sections(sections), summary(), machine_types(), machine_known(false), summary_decoded(false),
+      read_only_ranges(sections.get_decoder()->ELF_get_arena())
+{}
+
+/* Two 64-bit words in one SIMD register; the shuffles below move whole words between them. */
+typedef uint64_t ElfWordPair __attribute__((vector_size(16)));
+
+/* Unpack 64-bit entries that are in the host's byte order two at a time. A pair of entries is
+ * loaded as 16 byte vectors and its words are shuffled straight into the block's arrays.
+ * Returns how many entries were unpacked (all but the last one of an odd amount).
+ * */
+template<typename Traits, typename Entry>
+static inline uint32_t decode_native_pairs(const uint8_t *entries, uint32_t amnt, struct ElfRelocations::RelocationBlock &block)
+{
+    uint32_t i = 0;
+
+    for(; i + 2 <= amnt; i += 2)
+    {
+        const uint8_t *pair = entries + i * sizeof(Entry);
+        ElfWordPair first, second, offsets, infos;
+
+        memcpy(&first, pair, sizeof(first));
+        memcpy(&second, pair + sizeof(first), sizeof(second));
+
+        if constexpr(requires (Entry entry) { entry.r_addend; })
+        {
+            /* offset 0, info 0 | addend 0, offset 1 | info 1, addend 1 */
+            ElfWordPair third, addends;
+            memcpy(&third, pair + 2 * sizeof(first), sizeof(third));
+
+            offsets = __builtin_shuffle(first, second, (ElfWordPair) { 0, 3 });
+            infos = __builtin_shuffle(first, third, (ElfWordPair) { 1, 2 });
+            addends = __builtin_shuffle(second, third, (ElfWordPair) { 0, 3 });
+            memcpy(&block.addends[i], &addends, sizeof(addends));
+        }
+        else
+        {
+            /* offset 0, info 0 | offset 1, info 1 */
+            offsets = __builtin_shuffle(first, second, (ElfWordPair) { 0, 2 });
+            infos = __builtin_shuffle(first, second, (ElfWordPair) { 1, 3 });
+            block.addends[i] = block.addends[i + 1] = 0;
+        }
+
+        memcpy(&block.offsets[i], &offsets, sizeof(offsets));
+        block.types[i] = Traits::relocation_type(infos[0]);
+        block.types[i + 1] = Traits::relocation_type(infos[1]);
+        block.symbols[i] = Traits::relocation_symbol(infos[0]);
+        block.symbols[i + 1] = Traits::relocation_symbol(infos[1]);
+    }
+
+    return i;
+}
+
+/* Unpack entries `first` to `amnt`, `stride` bytes apart, into `block`, one field at a time (each
+ * load is followed by a `bswap` when the file's byte order is not the host's). Called with a constant
+ * `stride` for the usual entry sizes.
+ * */
+template<typename Traits, typename Entry>
+static inline void decode_block(const uint8_t *entries, uint64_t stride, uint32_t first, uint32_t amnt, struct ElfRelocations::RelocationBlock &block)
+{
+    using Word = typename Traits::Word;
+
+    for(uint32_t i = first; i < amnt; i++)
+    {
+        const uint8_t *entry = entries + i * stride;
+        Word info = ELF_read_value<Word, Traits::order>(entry + offsetof(Entry, r_info));
+
+        block.offsets[i] = ELF_read_value<Word, Traits::order>(entry + offsetof(Entry, r_offset));
+        block.types[i] = Traits::relocation_type(info);
+        block.symbols[i] = Traits::relocation_symbol(info);
+
+        if constexpr(requires (Entry raw) { raw.r_addend; })
+            block.addends[i] = (std::make_signed_t<Word>) ELF_read_value<Word, Traits::order>(entry + offsetof(Entry, r_addend));
+        else
+            block.addends[i] = 0;
+    }
+
+    block.amnt = amnt;
+}
+
+void ElfRelocations::count_block(const struct RelocationBlock &block, bool dynamic, bool packed)
+{
+    uint64_t *type_counts = summary.type_counts;
+
+    for(uint32_t i = 0; i < block.amnt; i++)
+        type_counts[std::min<uint32_t>(block.types[i], ELF_RELOCATION_MAX_TYPE)]++;
+
+    summary.relocation_amnt += block.amnt;
+
+    if(packed)
+    {
+        summary.relr_amnt += block.amnt;
+        summary.relative_amnt += block.amnt;
+    }
+    else if(machine_known)
+    {
+        for(uint32_t i = 0; i < block.amnt; i++)
+        {
+            summary.relative_amnt += block.types[i] == machine_types.relative;
+            summary.copy_amnt += block.types[i] == machine_types.copy;
+        }
+    }
+
+    if(!dynamic)
+        return;
+
+    summary.dynamic_amnt += block.amnt;
+
+    /* Only the read-only loadable segments matter; there usually are one or two. */
+    for(const auto &range : read_only_ranges)
+    {
+        for(uint32_t i = 0; i < block.amnt; i++)
+            summary.text_amnt += block.offsets[i] - range.address < range.size;
+    }
+}
+
+template<typename Traits, typename Entry>
+void ElfRelocations::decode_relocation_section(uint32_t section, const ElfSpan &table, uint64_t entry_size, uint64_t amnt, const block_function &handle_block)
+{
+    /* Allocated relocation sections are the ones the dynamic linker applies. */
+    bool dynamic = elf_sections.get_sections().flags[section] & (uint64_t) SectionFlags::SF_ALLOC;
+    struct RelocationBlock block;
+    block.section = section;
+
+    for(uint64_t done = 0; done < amnt; done += block.amnt)
+    {
+        uint32_t block_amnt = std::min<uint64_t>(amnt - done, ELF_RELOCATION_BLOCK_SIZE);
+        const uint8_t *entries = table.entry(done, entry_size);
+
+        if(entry_size != sizeof(Entry))
+            decode_block<Traits, Entry>(entries, entry_size, 0, block_amnt, block);
+        else if constexpr(sizeof(typename Traits::Word) == sizeof(uint64_t) && Traits::order == std::endian::native)
+            decode_block<Traits, Entry>(entries, sizeof(Entry), decode_native_pairs<Traits, Entry>(entries, block_amnt, block), block_amnt, block);
+        else
+            decode_block<Traits, Entry>(entries, sizeof(Entry), 0, block_amnt, block);
+
+        count_block(block, dynamic, false);
+
+        if(handle_block)
+            handle_block(block);
+    }
+}
+
+/* `SHT_RELR`: an even entry is the address of the next relocation; an odd entry is a bitmap of
+ * which of the (bits in a word - 1) words after the last address also get relocated.
+ * Every relocation in there is a relative one.
+ * */
+template<typename Traits>
+void ElfRelocations::decode_relr_section(uint32_t section, const ElfSpan &table, uint64_t amnt, const block_function &handle_block)
+{
+    using Word = typename Traits::Word;
+    constexpr uint32_t bitmap_bits = sizeof(Word) * 8 - 1;
+
+    struct RelocationBlock block;
+    block.section = section;
+    block.amnt = 0;
+
+    uint32_t relative = machine_known ? machine_types.relative : 0;
+    Word address = 0;
+
+    auto add = [&] (Word offset) {
+        block.offsets[block.amnt] = offset;
+        block.addends[block.amnt] = 0;
+        block.types[block.amnt] = relative;
+        block.symbols[block.amnt] = 0;
+
+        if(++block.amnt == ELF_RELOCATION_BLOCK_SIZE)
+        {
+            count_block(block, true, true);
+            if(handle_block)
+                handle_block(block);
+            block.amnt = 0;
+        }
+    };
+
+    for(uint64_t i = 0; i < amnt; i++)
+    {
+        Word entry = table.read<Word, Traits::order>(i * sizeof(Word));
+
+        if((entry & 1) == 0)
+        {
+            add(entry);
+            address = entry + sizeof(Word);
+            continue;
+        }
+
+        for(Word bits = entry >> 1, word = 0; bits != 0; bits >>= 1, word++)
+        {
+            if(bits & 1)
+                add(address + word * sizeof(Word));
+        }
+
+        address += bitmap_bits * sizeof(Word);
+    }
+
+    if(block.amnt == 0)
+        return;
+
+    count_block(block, true, true);
+    if(handle_block)
+        handle_block(block);
+}
+
+/* Size of an entry of relocation section `type` (`entry_size` is what the section header says), and
+ * the least it can be; false if `type` is not a relocation section.
+ * */
+template<typename Traits>
+static bool get_relocation_entry_size(SectionTypes type, uint64_t &entry_size, uint64_t &minimum_size)
+{
+    if(type == SectionTypes::SHT_REL)
+        minimum_size = sizeof(typename Traits::Rel);
+    else if(type == SectionTypes::SHT_RELA)
+        minimum_size = sizeof(typename Traits::Rela);
+    else if(type == SectionTypes::SHT_RELR)
+        minimum_size = entry_size = sizeof(typename Traits::Word);
+    else
+        return false;
+
+    return true;
+}
+
+template<typename Traits>
+ElfStatus ElfRelocations::validate_sections()
+{
+    const struct ElfSection::SectionTable &sections = elf_sections.get_sections();
+    uint32_t section_amnt = elf_sections.get_section_amnt();
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+    {
+        uint64_t entry_size = sections.entry_sizes[i];
+        uint64_t minimum_size = 0;
+
+        if(!get_relocation_entry_size<Traits>((SectionTypes) sections.types[i], entry_size, minimum_size))
+            continue;
+
+        if(entry_size < minimum_size)
+            return ELF_errors::Invalid_ELF_Relocations;
+
+        /* Only the whole entries are decoded, so only those have to be within the file. */
+        uint64_t amnt = sections.sizes[i] / entry_size;
+
+        if(amnt > 0 && !elf_sections.get_decoder()->ELF_table_fits(sections.offsets[i], amnt, entry_size))
+            return ELF_errors::Truncated_ELF_Binary;
+    }
+
+    return ElfStatus();
+}
+
+template<typename Traits>
+ElfStatus ElfRelocations::decode_relocations(const block_function &handle_block)
+{
+    const struct ElfSection::SectionTable &sections = elf_sections.get_sections();
+    uint32_t section_amnt = elf_sections.get_section_amnt();
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+    {
+        SectionTypes type = (SectionTypes) sections.types[i];
+        uint64_t entry_size = sections.entry_sizes[i];
+        uint64_t minimum_size = 0;
+
+        if(!get_relocation_entry_size<Traits>(type, entry_size, minimum_size))
+            continue;
+
+        summary.section_amnt++;
+
+        uint64_t amnt = sections.sizes[i] / entry_size;
+        if(amnt == 0)
+            continue;
+
+        /* The whole table is read in once, up front (in lazy mode); `validate` already made sure it is within the file. */
+        ElfResult<ElfSpan> table = elf_sections.get_decoder()->ELF_table_at(sections.offsets[i], amnt, entry_size);
+        if(!table)
+            return table.error();
+
+        if(type == SectionTypes::SHT_REL)
+            decode_relocation_section<Traits, typename Traits::Rel>(i, *table, entry_size, amnt, handle_block);
+        else if(type == SectionTypes::SHT_RELA)
+            decode_relocation_section<Traits, typename Traits::Rela>(i, *table, entry_size, amnt, handle_block);
+        else
+            decode_relr_section<Traits>(i, *table, amnt, handle_block);
+    }
+
+    return ElfStatus();
+}
+
+ElfStatus ElfRelocations::validate()
+{
+    ELF_TRY(elf_sections.get_section_header_table())
+    ELF_TRY(elf_sections.get_program_header_table())
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    return ELF_dispatch(header.ELF_type, header.ELF_endianess, [this] <typename Traits> () {
+        return validate_sections<Traits>();
+    });
+}
+
+ElfStatus ElfRelocations::decode_all(block_function handle_block)
+{
+    summary = {};
+    summary.type_counts = elf_sections.get_decoder()->ELF_get_arena().allocate<uint64_t>(ELF_RELOCATION_MAX_TYPE + 1);
+    memset(summary.type_counts, 0, (ELF_RELOCATION_MAX_TYPE + 1) * sizeof(uint64_t));
+    summary_decoded = true;
+
+    /* Nothing gets handed to `handle_block` unless every section checks out. */
+    ELF_TRY(validate())
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+    machine_known = get_machine_relocation_types((ELF_machine_types) header.ELF_machine_type, machine_types);
+
+    /* A dynamic relocation that lands in one of these needs the text to be made writable (`TEXTREL`). */
+    read_only_ranges.clear();
+    for(uint32_t i = 0; i < elf_sections.get_program_header_amnt(); i++)
+    {
+        const struct ElfProgramHeader::ProgramHeader &segment = elf_sections.get_program_header(i);
+
+        if(segment.p_type == (uint32_t) SegmentTypes::ST_LOAD && !(segment.p_flags & (uint32_t) SegmentFlags::SF_WRITE))
+            read_only_ranges.push_back({ segment.p_virtual_address, segment.p_memory_size });
+    }
+
+    return ELF_dispatch(header.ELF_type, header.ELF_endianess, [this, &handle_block] <typename Traits> () {
+        return decode_relocations<Traits>(handle_block);
+    });
+}
+
+void ElfRelocations::print_relocation_summary(ElfOutput &out)
+{
+    const struct RelocationSummary &relocations = get_summary();
+    ELF_machine_types machine = (ELF_machine_types) elf_sections.get_header().ELF_machine_type;
+
+    out.text("\tRelocations (").color(ELF_COLOR_DESCRIPTION).decimal(relocations.relocation_amnt).text(" in ")
+        .decimal(relocations.section_amnt).text(" sections").color(ELF_COLOR_RESET).text("):\n");
+
+    out.text("\t\tDynamic: ").color(ELF_COLOR_VALUE).decimal(relocations.dynamic_amnt).color(ELF_COLOR_RESET)
+        .text("  Relative: ").color(ELF_COLOR_VALUE).decimal(relocations.relative_amnt).color(ELF_COLOR_RESET)
+        .text("  Packed (RELR): ").color(ELF_COLOR_VALUE).decimal(relocations.relr_amnt).color(ELF_COLOR_RESET)
+        .text("  Copy: ").color(ELF_COLOR_VALUE).decimal(relocations.copy_amnt).color(ELF_COLOR_RESET)
+        .text("  Text: ").color(ELF_COLOR_VALUE).decimal(relocations.text_amnt).color(ELF_COLOR_RESET).text("\n");
+
+    for(uint32_t type = 0; type <= ELF_RELOCATION_MAX_TYPE; type++)
+    {
+        if(relocations.type_counts[type] == 0)
+            continue;
+
+        out.text("\t\t");
+        if(type == ELF_RELOCATION_MAX_TYPE)
+            out.description("Other Relocation Types");
+        else
+            out.description((const char *) get_relocation_type_name(machine, type)).text(" (").value_hex(type).text(")");
+        out.text(": ").color(ELF_COLOR_VALUE).decimal(relocations.type_counts[type]).color(ELF_COLOR_RESET).text("\n");
+    }
+
+    out.text("\n");
+}
+
+void ElfRelocations::print_relocation_list(ElfOutput &out)
+{
+    ELF_machine_types machine = (ELF_machine_types) elf_sections.get_header().ELF_machine_type;
+    uint32_t last_section = elf_sections.get_section_amnt();
+
+    decode_all([&] (const struct RelocationBlock &block) {
+        if(block.section != last_section)
+        {
+            last_section = block.section;
+            out.text("\tRelocation Section ").description(elf_sections.get_section_name(block.section)).text(":\n");
+        }
+
+        for(uint32_t i = 0; i < block.amnt; i++)
+        {
+            out.text("\t\tOffset: ").value_hex(block.offsets[i])
+                .text("  Type: ").description((const char *) get_relocation_type_name(machine, block.types[i]))
+                .text("  Symbol: ").color(ELF_COLOR_VALUE).decimal(block.symbols[i]).color(ELF_COLOR_RESET)
+                .text("  Addend: ");
+
+            if(block.addends[i] < 0)
+                out.character('-').value_hex(-(uint64_t) block.addends[i]);
+            else
+                out.value_hex(block.addends[i]);
+            out.text("\n");
+        }
+    });
+
+    out.text("\n");
+}
+
+void ElfRelocations::print_relocation_summary_json(ElfOutput &out)
+{
+    const struct RelocationSummary &relocations = get_summary();
+
+    out.json_key("relocations").character('{')
+        .json_key("total").decimal(relocations.relocation_amnt).character(',')
+        .json_key("sections").decimal(relocations.section_amnt).character(',')
+        .json_key("dynamic").decimal(relocations.dynamic_amnt).character(',')
+        .json_key("relative").decimal(relocations.relative_amnt).character(',')
+        .json_key("relr").decimal(relocations.relr_amnt).character(',')
+        .json_key("copy").decimal(relocations.copy_amnt).character(',')
+        .json_key("textrel").decimal(relocations.text_amnt).character(',')
+        .json_key("types").character('{');
+
+    bool first = true;
+    for(uint32_t type = 0; type <= ELF_RELOCATION_MAX_TYPE; type++)
+    {
+        if(relocations.type_counts[type] == 0)
+            continue;
+
+        if(!first)
+            out.character(',');
+        first = false;
+
+        /* Keys have to be strings; the last bucket is every type past the others. */
+        out.character('"');
+        if(type == ELF_RELOCATION_MAX_TYPE)
+            out.text("other");
+        else
+            out.decimal(type);
+        out.text("\":").decimal(relocations.type_counts[type]);
+    }
+
+    out.text("}}");
+}
+
+void ElfRelocations::print_relocation_list_json(ElfOutput &out)
+{
+    bool first = true;
+
+    out.json_key("relocation_list").character('[');
+
+    decode_all([&] (const struct RelocationBlock &block) {
+        std::string_view section_name = elf_sections.get_section_name(block.section);
+
+        for(uint32_t i = 0; i < block.amnt; i++)
+        {
+            if(!first)
+                out.character(',');
+            first = false;
+
+            out.character('{')
+                .json_key("section").json_string(section_name).character(',')
+                .json_key("offset").decimal(block.offsets[i]).character(',')
+                .json_key("type").decimal(block.types[i]).character(',')
+                .json_key("symbol").decimal(block.symbols[i]).character(',')
+                .json_key("addend");
+
+            if(block.addends[i] < 0)
+                out.character('-').decimal(-(uint64_t) block.addends[i]);
+            else
+                out.decimal(block.addends[i]);
+            out.character('}');
+        }
+    });
+
+    out.character(']');
+}
@@ -0,0 +1,142 @@
+#include <elf_scan.hpp>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+using namespace elf_scan;
+
+ElfDirectoryScan::ElfDirectoryScan(uint32_t workers)
+    : worker_amnt(workers), busy_workers(0)
+{
+    if(worker_amnt == 0)
+        worker_amnt = std::thread::hardware_concurrency();
+    if(worker_amnt == 0)
+        worker_amnt = 1;
+}
+
+bool ElfDirectoryScan::is_elf_file(int directory_fd, const char *name)
+{
+    /* `O_NOFOLLOW`/`O_NONBLOCK`: never end up waiting on something that was swapped in for a FIFO. */
+    int fd = openat(directory_fd, name, O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
+
+    uint8_t magic[4];
+    bool is_elf = pread(fd, magic, sizeof(magic), 0) == sizeof(magic)
+        && ELF_read_value<uint32_t, std::endian::big>(magic) == ELF_MAGIC_NUMBER;
+
+    close(fd);
+    return is_elf;
+}
+
+/* Returns false if the directory has already been (or is being) walked. */
+bool ElfDirectoryScan::add_directory(dev_t device, ino_t inode)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return visited.insert({ device, inode }).second;
+}
+
+void ElfDirectoryScan::scan_directory(const std::string &path, std::vector<std::string> &subdirectories, std::vector<struct ElfScannedFile> &found)
+{
+    /* Subdirectories only get queued when `readdir` says they are real directories, so this only
+     * follows a symbolic link for the root the scan was started at.
+     * */
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd < 0)
+        return;
+
+    struct stat directory_stats;
+    if(fstat(fd, &directory_stats) != 0 || !add_directory(directory_stats.st_dev, directory_stats.st_ino))
+    {
+        close(fd);
+        return;
+    }
+
+    DIR *directory = fdopendir(fd);
+    if(!directory)
+    {
+        close(fd);
+        return;
+    }
+
+    const char *separator = path.back() == '/' ? "" : "/";
+    struct dirent *entry;
+
+    while((entry = readdir(directory)) != nullptr)
+    {
+        if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        uint8_t type = entry->d_type;
+
+        /* Some filesystems don't fill in `d_type`. */
+        if(type == DT_UNKNOWN)
+        {
+            struct stat entry_stats;
+            if(fstatat(fd, entry->d_name, &entry_stats, AT_SYMLINK_NOFOLLOW) != 0)
+                continue;
+
+            if(S_ISDIR(entry_stats.st_mode)) type = DT_DIR;
+            else if(S_ISREG(entry_stats.st_mode)) type = DT_REG;
+        }
+
+        uint64_t tag = ELF_SCAN_NO_TAG;
+
+        if(type == DT_DIR)
+            subdirectories.push_back(path + separator + entry->d_name);
+        else if(type == DT_REG && ((is_known && is_known(fd, entry->d_name, tag)) || is_elf_file(fd, entry->d_name)))
+            found.push_back({ path + separator + entry->d_name, tag });
+    }
+
+    /* Also closes `fd`. */
+    closedir(directory);
+}
+
+void ElfDirectoryScan::run_worker()
+{
+    std::vector<std::string> subdirectories;
+    std::vector<struct ElfScannedFile> found;
+    std::unique_lock<std::mutex> guard(lock);
+
+    while(true)
+    {
+        /* Done once nothing is queued and nobody is still walking a directory that could queue more. */
+        work_available.wait(guard, [this] () { return !directories.empty() || busy_workers == 0; });
+        if(directories.empty())
+            break;
+
+        std::string path = std::move(directories.front());
+        directories.pop_front();
+        busy_workers++;
+
+        guard.unlock();
+        scan_directory(path, subdirectories, found);
+        guard.lock();
+
+        busy_workers--;
+        for(auto &subdirectory : subdirectories)
+            directories.push_back(std::move(subdirectory));
+        for(auto &file : found)
+            elf_files.push_back(std::move(file));
+
+        subdirectories.clear();
+        found.clear();
+        work_available.notify_all();
+    }
+}
+
+void ElfDirectoryScan::scan(const char *root, std::vector<struct ElfScannedFile> &files)
+{
+    elf_files.clear();
+    directories.assign(1, root);
+
+    std::vector<std::thread> workers;
+    for(uint32_t i = 0; i < worker_amnt; i++)
+        workers.emplace_back(&ElfDirectoryScan::run_worker, this);
+
+    for(auto &worker : workers)
+        worker.join();
+
+    /* The walk finishes in whatever order the threads get to things; sort so the output is stable. */
+    std::sort(elf_files.begin(), elf_files.end());
+    files.insert(files.end(), std::make_move_iterator(elf_files.begin()), std::make_move_iterator(elf_files.end()));
+}
@@ -1,2 +1,268 @@
 #include <elf_sections.hpp>
-using namespace elf_sections;
\ No newline at end of file
+using namespace elf_sections;
+
+template<typename Traits>
+ElfStatus ElfSection::decode_section_header_table()
+{
+    if(elf_header->ELF_SH_offset == 0)
+        return ElfStatus();
+
+    section_amnt = elf_header->ELF_SH_entry_amnt;
+    section_str_index = elf_header->ELF_SH_str_index;
+
+    /* With extended numbering, section header 0 holds the real amount of sections and/or the
+     * real index of the section name string table.
+     * */
+    if(section_amnt == 0 || section_str_index == ELF_SH_EXTENDED_INDEX)
+    {
+        ElfResult<const uint8_t *> loaded = edecoder->ELF_data_at(elf_header->ELF_SH_offset, Traits::section_header_size);
+        if(!loaded)
+            return loaded.error();
+
+        const auto first = Traits::template overlay<typename Traits::SectionHeader>(*loaded);
+        uint64_t real_amnt = Traits::get(first.sh_size);
+
+        if(real_amnt > UINT32_MAX)
+            return ELF_errors::Invalid_ELF_SectionHT;
+
+        if(section_amnt == 0) section_amnt = real_amnt;
+        if(section_str_index == ELF_SH_EXTENDED_INDEX) section_str_index = Traits::get(first.sh_link);
+    }
+
+    size_t entry_size = elf_header->ELF_SH_size;
+    ElfResult<ElfSpan> table = edecoder->ELF_table_at(elf_header->ELF_SH_offset, section_amnt, entry_size);
+    if(!table)
+        return table.error();
+
+    ElfArena &arena = edecoder->ELF_get_arena();
+
+    sections.names = arena.allocate<uint32_t>(section_amnt);
+    sections.types = arena.allocate<uint32_t>(section_amnt);
+    sections.flags = arena.allocate<uint64_t>(section_amnt);
+    sections.addresses = arena.allocate<uint64_t>(section_amnt);
+    sections.offsets = arena.allocate<uint64_t>(section_amnt);
+    sections.sizes = arena.allocate<uint64_t>(section_amnt);
+    sections.links = arena.allocate<uint32_t>(section_amnt);
+    sections.infos = arena.allocate<uint32_t>(section_amnt);
+    sections.alignments = arena.allocate<uint64_t>(section_amnt);
+    sections.entry_sizes = arena.allocate<uint64_t>(section_amnt);
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+    {
+        const auto entry = Traits::template overlay<typename Traits::SectionHeader>(table->entry(i, entry_size));
+
+        sections.names[i] = Traits::get(entry.sh_name);
+        sections.types[i] = Traits::get(entry.sh_type);
+        sections.flags[i] = Traits::get(entry.sh_flags);
+        sections.addresses[i] = Traits::get(entry.sh_addr);
+        sections.offsets[i] = Traits::get(entry.sh_offset);
+        sections.sizes[i] = Traits::get(entry.sh_size);
+        sections.links[i] = Traits::get(entry.sh_link);
+        sections.infos[i] = Traits::get(entry.sh_info);
+        sections.alignments[i] = Traits::get(entry.sh_addralign);
+        sections.entry_sizes[i] = Traits::get(entry.sh_entsize);
+    }
+
+    if(section_str_index != ELF_SH_UNDEFINED && section_str_index >= section_amnt)
+        return ELF_errors::Invalid_ELF_SectionHT;
+
+    /* Every section name is looked up in there, so it had better be within the file; nothing gets read in yet. */
+    if(section_str_index != ELF_SH_UNDEFINED && sections.types[section_str_index] == (uint32_t) SectionTypes::SHT_STRTAB
+        && !edecoder->ELF_table_fits(sections.offsets[section_str_index], sections.sizes[section_str_index], 1))
+        return ELF_errors::Truncated_ELF_Binary;
+
+    return ElfStatus();
+}
+
+ElfStatus ElfSection::get_section_header_table()
+{
+    if(sections_decoded) return sections_status;
+    sections_decoded = true;
+
+    sections_status = get_elf_header();
+
+    if(sections_status)
+        sections_status = ELF_dispatch(elf_header->ELF_type, elf_header->ELF_endianess, [this] <typename Traits> () {
+            return decode_section_header_table<Traits>();
+        });
+
+    if(!sections_status)
+    {
+        section_amnt = 0;
+        section_str_index = ELF_SH_UNDEFINED;
+    }
+
+    return sections_status;
+}
+
+ElfStringTable ElfSection::get_string_table(uint32_t index)
+{
+    get_section_header_table();
+
+    if(index >= section_amnt || sections.types[index] != (uint32_t) SectionTypes::SHT_STRTAB)
+        return ElfStringTable();
+
+    /* In lazy mode, this reads in just the string table. */
+    ElfResult<const uint8_t *> table = edecoder->ELF_data_at(sections.offsets[index], sections.sizes[index]);
+
+    /* A string table that is not all there has no strings. */
+    if(!table)
+        return ElfStringTable();
+
+    return ElfStringTable(*table, sections.sizes[index]);
+}
+
+std::string_view ElfSection::get_section_name(uint32_t index)
+{
+    get_section_header_table();
+
+    if(!section_names_loaded)
+    {
+        section_names = get_string_table(section_str_index);
+        section_names_loaded = true;
+    }
+
+    if(index >= section_amnt)
+        return std::string_view();
+
+    return section_names.get_string(sections.names[index]);
+}
+
+uint32_t ElfSection::find_section_by_name(std::string_view name)
+{
+    get_section_header_table();
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+        if(get_section_name(i) == name)
+            return i;
+
+    return section_amnt;
+}
+
+uint32_t ElfSection::find_section_by_type(SectionTypes type, uint32_t start)
+{
+    get_section_header_table();
+
+    for(uint32_t i = start; i < section_amnt; i++)
+        if(sections.types[i] == (uint32_t) type)
+            return i;
+
+    return section_amnt;
+}
+
+uint32_t ElfSection::get_sections_with_flags(uint64_t flags, std::vector<uint32_t> &indexes)
+{
+    get_section_header_table();
+
+    uint32_t matched = 0;
+    const uint64_t *section_flags = sections.flags;
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+    {
+        if((section_flags[i] & flags) == flags)
+        {
+            indexes.push_back(i);
+            matched++;
+        }
+    }
+
+    return matched;
+}
+
+uint64_t ElfSection::get_total_size_by_type(SectionTypes type)
+{
+    get_section_header_table();
+
+    uint64_t total = 0;
+    const uint32_t *types = sections.types;
+    const uint64_t *sizes = sections.sizes;
+
+    /* No early exits or index bookkeeping, so this stays a straight (vectorizable) scan. */
+    for(uint32_t i = 0; i < section_amnt; i++)
+        total += types[i] == (uint32_t) type ? sizes[i] : 0;
+
+    return total;
+}
+
+void ElfSection::print_elf_section_header_table(ElfOutput &out)
+{
+    get_section_header_table();
+
+    /* Same letters `readelf` uses. */
+    const auto flag_letters = [] (uint64_t flags, char *letters)
+    {
+        const char all_letters[] = "WAX?MSILOGTC";
+        uint8_t amnt = 0;
+
+        for(uint8_t bit = 0; bit < sizeof(all_letters) - 1; bit++)
+            if(flags & (1ull << bit))
+                letters[amnt++] = all_letters[bit];
+
+        letters[amnt] = '\0';
+    };
+
+    char letters[16];
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+    {
+        flag_letters(sections.flags[i], letters);
+
+        out.text("\tSection Header Entry #").decimal(i).text(":\n");
+        out.text("\t\tSection Name:       ").description(get_section_name(i)).text("\n");
+        out.text("\t\tSection Type:       ").value_hex(sections.types[i])
+            .text(" (").description((const char *) get_section_type_name((SectionTypes) sections.types[i])).text(")\n");
+        out.text("\t\tFlags:              ").value_hex(sections.flags[i]).text(" (").description(letters).text(")")
+            .text("\n\t\tAddress:            ").value_hex(sections.addresses[i])
+            .text("\n\t\tOffset:             ").value_hex(sections.offsets[i]).text("\n");
+        out.text("\t\tSize:               ").value_hex(sections.sizes[i])
+            .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(sections.sizes[i]).text(" bytes").color(ELF_COLOR_RESET).text(")")
+            .text("\n\t\tLink:               ").value_hex(sections.links[i])
+            .text("\n\t\tInfo:               ").value_hex(sections.infos[i]).text("\n");
+        out.text("\t\tAlignment:          ").value_hex(sections.alignments[i])
+            .text("\n\t\tEntry Size:         ").value_hex(sections.entry_sizes[i]).text("\n\n");
+    }
+
+    uint32_t allocated_amnt = 0;
+    uint64_t allocated_size = 0;
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+    {
+        if(!(sections.flags[i] & (uint64_t) SectionFlags::SF_ALLOC))
+            continue;
+
+        allocated_amnt++;
+        allocated_size += sections.types[i] == (uint32_t) SectionTypes::SHT_NOBITS ? 0 : sections.sizes[i];
+    }
+
+    out.text("\tSections Occupying Memory:     ").color(ELF_COLOR_VALUE).decimal(allocated_amnt).color(ELF_COLOR_RESET)
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(allocated_size).text(" bytes in the file, ")
+        .decimal(get_total_size_by_type(SectionTypes::SHT_NOBITS)).text(" bytes of bss").color(ELF_COLOR_RESET).text(")\n\n");
+}
+
+void ElfSection::print_elf_section_header_table_json(ElfOutput &out)
+{
+    get_section_header_table();
+
+    out.json_key("sections").character('[');
+
+    for(uint32_t i = 0; i < section_amnt; i++)
+    {
+        if(i > 0)
+            out.character(',');
+
+        out.character('{')
+            .json_key("name").json_string(get_section_name(i)).character(',')
+            .json_key("type").decimal(sections.types[i]).character(',')
+            .json_key("type_name").json_string((const char *) get_section_type_name((SectionTypes) sections.types[i])).character(',')
+            .json_key("flags").decimal(sections.flags[i]).character(',')
+            .json_key("addr").decimal(sections.addresses[i]).character(',')
+            .json_key("offset").decimal(sections.offsets[i]).character(',')
+            .json_key("size").decimal(sections.sizes[i]).character(',')
+            .json_key("link").decimal(sections.links[i]).character(',')
+            .json_key("info").decimal(sections.infos[i]).character(',')
+            .json_key("addralign").decimal(sections.alignments[i]).character(',')
+            .json_key("entsize").decimal(sections.entry_sizes[i]).character('}');
+    }
+
+    out.character(']');
+}
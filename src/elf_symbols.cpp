@@ -0,0 +1,203 @@
+#include <elf_symbols.hpp>
+using namespace elf_symbols;
+
+ElfSymbolTable::ElfSymbolTable(ElfSection &sections, SectionTypes type)
+    : elf_sections(sections), table_index(UINT32_MAX), table_type(type), symbols(nullptr), symbol_amnt(0),
+      symbols_decoded(false), index_symbols(nullptr), index_hashes(nullptr), index_mask(0), index_built(false)
+{}
+
+void ElfSymbolTable::reset()
+{
+    /* The section is only looked for once the section header table gets decoded. */
+    table_index = UINT32_MAX;
+    symbols = nullptr;
+    symbol_amnt = 0;
+    symbols_decoded = false;
+    symbols_status = ElfStatus();
+    symbol_names = ElfStringTable();
+    index_symbols = nullptr;
+    index_hashes = nullptr;
+    index_mask = 0;
+    index_built = false;
+}
+
+template<typename Traits>
+ElfStatus ElfSymbolTable::decode_symbol_table()
+{
+    const struct ElfSection::SectionTable &sections = elf_sections.get_sections();
+    uint64_t entry_size = sections.entry_sizes[table_index];
+
+    if(entry_size < Traits::symbol_size)
+        return ELF_errors::Invalid_ELF_Symbols;
+
+    uint64_t amnt = sections.sizes[table_index] / entry_size;
+    if(amnt > ELF_SYMBOLS_MAX)
+        return ELF_errors::Invalid_ELF_Symbols;
+
+    if(amnt == 0)
+        return ElfStatus();
+
+    ElfResult<ElfSpan> table = elf_sections.get_decoder()->ELF_table_at(sections.offsets[table_index], amnt, entry_size);
+    if(!table)
+        return table.error();
+    symbol_amnt = amnt;
+    symbol_names = elf_sections.get_string_table(sections.links[table_index]);
+
+    /* A 64-bit table in the host's byte order is already laid out like `Symbol`. */
+    if constexpr(std::is_same<typename Traits::Symbol, struct ELF64_raw_symbol>::value
+        && Traits::order == std::endian::native)
+    {
+        if(entry_size == sizeof(struct Symbol) && (uintptr_t) table->data() % alignof(struct Symbol) == 0)
+        {
+            symbols = (const struct Symbol *) table->data();
+            return ElfStatus();
+        }
+    }
+
+    /* The whole table in one piece, in the file's arena. */
+    struct Symbol *symbol_storage = elf_sections.get_decoder()->ELF_get_arena().allocate<struct Symbol>(symbol_amnt);
+
+    for(uint32_t i = 0; i < symbol_amnt; i++)
+    {
+        const auto entry = Traits::template overlay<typename Traits::Symbol>(table->entry(i, entry_size));
+        struct Symbol &decoded = symbol_storage[i];
+
+        decoded.st_name = Traits::get(entry.st_name);
+        decoded.st_info = entry.st_info;
+        decoded.st_other = entry.st_other;
+        decoded.st_section_index = Traits::get(entry.st_shndx);
+        decoded.st_value = Traits::get(entry.st_value);
+        decoded.st_size = Traits::get(entry.st_size);
+    }
+
+    symbols = symbol_storage;
+    return ElfStatus();
+}
+
+ElfStatus ElfSymbolTable::get_symbol_table()
+{
+    if(symbols_decoded) return symbols_status;
+    symbols_decoded = true;
+
+    /* Without a section header table, there is no symbol table to find. */
+    symbols_status = elf_sections.get_section_header_table();
+    if(!symbols_status)
+        return symbols_status;
+
+    table_index = elf_sections.find_section_by_type(table_type);
+    if(table_index >= elf_sections.get_section_amnt())
+        return symbols_status;
+
+    const struct ElfHeader::ELF_header &header = elf_sections.get_header();
+
+    symbols_status = ELF_dispatch(header.ELF_type, header.ELF_endianess, [this] <typename Traits> () {
+        return decode_symbol_table<Traits>();
+    });
+
+    return symbols_status;
+}
+
+void ElfSymbolTable::build_name_index()
+{
+    if(index_built) return;
+    index_built = true;
+
+    get_symbol_table();
+
+    /* At most half of the slots are ever used, so probe sequences stay short.
+     * With at most `ELF_SYMBOLS_MAX` symbols, that is at most 2^31 slots.
+     * */
+    uint64_t slot_amnt = std::bit_ceil(std::max<uint64_t>((uint64_t) symbol_amnt * 2, 16));
+
+    /* Both in the file's arena; a slot's hash is only looked at once its symbol is set. */
+    ElfArena &arena = elf_sections.get_decoder()->ELF_get_arena();
+    index_symbols = arena.allocate<uint32_t>(slot_amnt);
+    index_hashes = arena.allocate<uint32_t>(slot_amnt);
+    index_mask = slot_amnt - 1;
+    memset(index_symbols, 0, slot_amnt * sizeof(uint32_t));
+
+    /* Symbol 0 is always the undefined symbol. Symbols are added in order, so a lookup of a
+     * name that is used more than once finds the first symbol with that name.
+     * */
+    for(uint32_t i = 1; i < symbol_amnt; i++)
+    {
+        std::string_view name = get_symbol_name(i);
+        if(name.empty())
+            continue;
+
+        uint32_t hash = hash_name(name);
+        uint32_t slot = hash & index_mask;
+
+        while(index_symbols[slot] != 0)
+            slot = (slot + 1) & index_mask;
+
+        index_symbols[slot] = i + 1;
+        index_hashes[slot] = hash;
+    }
+}
+
+uint32_t ElfSymbolTable::find_symbol(std::string_view name)
+{
+    build_name_index();
+
+    uint32_t hash = hash_name(name);
+
+    for(uint32_t slot = hash & index_mask; index_symbols[slot] != 0; slot = (slot + 1) & index_mask)
+    {
+        /* Only compare the names when the hashes match. */
+        if(index_hashes[slot] == hash && get_symbol_name(index_symbols[slot] - 1) == name)
+            return index_symbols[slot] - 1;
+    }
+
+    return symbol_amnt;
+}
+
+void ElfSymbolTable::print_symbol_table(ElfOutput &out)
+{
+    if(!is_present())
+        return;
+
+    out.text("\tSymbol Table ").description(get_table_name())
+        .text(" (").color(ELF_COLOR_DESCRIPTION).decimal(symbol_amnt).text(" entries").color(ELF_COLOR_RESET).text("):\n");
+
+    for(uint32_t i = 0; i < symbol_amnt; i++)
+    {
+        const struct Symbol &symbol = symbols[i];
+
+        out.text("\t\tSymbol #").decimal(i).text(":\tValue: ").value_hex(symbol.st_value)
+            .text("  Size: ").color(ELF_COLOR_VALUE).decimal(symbol.st_size).color(ELF_COLOR_RESET)
+            .text("  Type: ").description((const char *) get_symbol_type_name((SymbolTypes) ELF_SYMBOL_TYPE(symbol.st_info)))
+            .text("  Binding: ").description((const char *) get_symbol_binding_name((SymbolBindings) ELF_SYMBOL_BINDING(symbol.st_info)))
+            .text("  Visibility: ").description((const char *) get_symbol_visibility_name((SymbolVisibilities) ELF_SYMBOL_VISIBILITY(symbol.st_other)))
+            .text("  Section: ").value_hex(symbol.st_section_index)
+            .text("  Name: ").description(get_symbol_name(i)).text("\n");
+    }
+
+    out.text("\n");
+}
+
+void ElfSymbolTable::print_symbol_table_json(ElfOutput &out)
+{
+    get_symbol_table();
+
+    out.json_key(table_type == SectionTypes::SHT_DYNSYM ? "dynsym" : "symtab").character('[');
+
+    for(uint32_t i = 0; i < symbol_amnt; i++)
+    {
+        const struct Symbol &symbol = symbols[i];
+
+        if(i > 0)
+            out.character(',');
+
+        out.character('{')
+            .json_key("name").json_string(get_symbol_name(i)).character(',')
+            .json_key("value").decimal(symbol.st_value).character(',')
+            .json_key("size").decimal(symbol.st_size).character(',')
+            .json_key("type").decimal(ELF_SYMBOL_TYPE(symbol.st_info)).character(',')
+            .json_key("bind").decimal(ELF_SYMBOL_BINDING(symbol.st_info)).character(',')
+            .json_key("visibility").decimal(ELF_SYMBOL_VISIBILITY(symbol.st_other)).character(',')
+            .json_key("shndx").decimal(symbol.st_section_index).character('}');
+    }
+
+    out.character(']');
+}